@@ -0,0 +1,70 @@
+#ifndef UNP_LATENCY_HISTOGRAM_INC
+#define UNP_LATENCY_HISTOGRAM_INC
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief 对数线性直方图: 小于32ns的值精确记录, 其余按2的幂分段, 每段16个桶(误差约6%)
+ */
+class LatencyHistogram {
+public:
+    static const int BUCKETS = 32 + 59 * 16;
+
+    void add(uint64_t v)
+    {
+        counts_[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void accumulate(std::vector<uint64_t> &out) const
+    {
+        for (int i = 0; i < BUCKETS; i++)
+            out[i] += counts_[i].load(std::memory_order_relaxed);
+    }
+
+    static int bucket(uint64_t v)
+    {
+        if (v < 32)
+            return (int) v;
+        int e = 63 - __builtin_clzll(v);
+        int m = (int) (v >> (e - 4));
+        return 32 + (e - 5) * 16 + (m - 16);
+    }
+
+    static uint64_t lowerBound(int b)
+    {
+        if (b < 32)
+            return b;
+        int e = (b - 32) / 16 + 5;
+        uint64_t m = (b - 32) % 16 + 16;
+        return m << (e - 4);
+    }
+
+private:
+    std::atomic<uint64_t> counts_[BUCKETS] = {};  // 长时间高速运行时32位计数会回绕
+};
+
+/**
+ * @brief 从累加后的直方图计数中求百分位数
+ *
+ * @param hist 各桶的计数
+ * @param total 样本总数
+ * @param p 百分位, 如0.99
+ *
+ * @return 百分位数所在桶的下界
+ */
+inline uint64_t percentile(const std::vector<uint64_t> &hist, uint64_t total, double p)
+{
+    uint64_t rank = (uint64_t) (total * p);
+    uint64_t seen = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; i++) {
+        seen += hist[i];
+        if (seen > rank)
+            return LatencyHistogram::lowerBound(i);
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "err_quit.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+/**
+ * iftable: 比较查询本机接口MTU和"是否本机地址"的几种方式
+ *
+ *   ioctl      每次查询调用SIOCGIFCONF/SIOCGIFMTU, 与get_if_info.cpp相同
+ *   getifaddrs 每次查询调用getifaddrs(glibc内部做一次netlink dump)
+ *   table      InterfaceTable::current(), 没有系统调用
+ *
+ * 不带参数时打印接口表, 然后每当接口表变化时重新打印;
+ * -b N: 每种方式各查询N次, 报告每次查询的耗时
+ */
+
+static inline uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void print_table(const InterfaceSnapshot &snapshot)
+{
+    printf("generation %llu\n", (unsigned long long) snapshot.generation());
+    for (const InterfaceInfo &info: snapshot.interfaces()) {
+        printf("%d: %s %s mtu %u\n", info.index, info.name.c_str(), info.isUp() ? "up" : "down", info.mtu);
+        for (const InterfaceAddress &a: info.addresses) {
+            char buf[ADDRESS_PORT_STRLEN];
+            CompactSocketAddress addr = a.toCompactAddress();
+            sockaddr_storage ss;
+            socklen_t salen = addr.toSockaddr(&ss);
+            if (format_address((sockaddr *) &ss, salen, buf, sizeof(buf)) == 0)
+                strcpy(buf, "?");
+            printf("\t%s/%d scope %d%s\n", buf, a.prefixLen, a.scope, a.isUsable() ? "" : " (unusable)");
+        }
+    }
+    fflush(stdout);
+}
+
+// get_if_info.cpp的做法: SIOCGIFCONF列出IPv4接口, 逐个比较地址
+static bool ioctl_is_local(int sockfd, const sockaddr_in *sin)
+{
+    ifreq ifr_arr[32];
+    ifconf ifc;
+    ifc.ifc_len = sizeof(ifr_arr);
+    ifc.ifc_buf = (char *) ifr_arr;
+    if (ioctl(sockfd, SIOCGIFCONF, &ifc) < 0)
+        err_quit("ioctl error: SIOCGIFCONF");
+
+    int count = ifc.ifc_len / sizeof(ifreq);
+    for (int i = 0; i < count; i++) {
+        const sockaddr_in *a = (const sockaddr_in *) &ifr_arr[i].ifr_addr;
+        if (a->sin_addr.s_addr == sin->sin_addr.s_addr)
+            return true;
+    }
+    return false;
+}
+
+static int ioctl_mtu(int sockfd, const char *ifname)
+{
+    ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    if (ioctl(sockfd, SIOCGIFMTU, &ifr) < 0)
+        err_quit("ioctl error: SIOCGIFMTU");
+    return ifr.ifr_mtu;
+}
+
+static bool getifaddrs_is_local(const sockaddr_in *sin)
+{
+    ifaddrs *list;
+    if (getifaddrs(&list) < 0)
+        err_quit("getifaddrs error");
+
+    bool found = false;
+    for (ifaddrs *ifa = list; ifa != NULL && !found; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr != NULL && ifa->ifa_addr->sa_family == AF_INET)
+            found = ((const sockaddr_in *) ifa->ifa_addr)->sin_addr.s_addr == sin->sin_addr.s_addr;
+    }
+    freeifaddrs(list);
+    return found;
+}
+
+static void report(const char *name, int n, uint64_t start, int hits)
+{
+    printf("%-24s %8.1f ns per query (%d hits)\n", name, (double) (now_ns() - start) / n, hits);
+}
+
+static void benchmark(int n)
+{
+    InterfaceTable &table = InterfaceTable::instance();
+    const InterfaceInfo *lo = table.current().findByIndex(if_nametoindex("lo"));
+    if (lo == NULL)
+        err_quit("no loopback interface");
+
+    sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0)
+        err_quit("socket error");
+
+    uint64_t start = now_ns();
+    int hits = 0;
+    for (int i = 0; i < n; i++)
+        hits += ioctl_mtu(sockfd, "lo") > 0;
+    report("ioctl mtu", n, start, hits);
+
+    start = now_ns();
+    hits = 0;
+    for (int i = 0; i < n; i++)
+        hits += table.current().getMtu(lo->index) > 0;
+    report("table mtu", n, start, hits);
+
+    start = now_ns();
+    hits = 0;
+    for (int i = 0; i < n; i++)
+        hits += ioctl_is_local(sockfd, &sin);
+    report("ioctl is_local", n, start, hits);
+
+    start = now_ns();
+    hits = 0;
+    for (int i = 0; i < n; i++)
+        hits += getifaddrs_is_local(&sin);
+    report("getifaddrs is_local", n, start, hits);
+
+    start = now_ns();
+    hits = 0;
+    for (int i = 0; i < n; i++)
+        hits += table.current().isLocalAddress((const sockaddr *) &sin);
+    report("table is_local", n, start, hits);
+
+    start = now_ns();
+    hits = 0;
+    for (int i = 0; i < n; i++)
+        hits += table.current().findOnLink((const sockaddr *) &sin) != NULL;
+    report("table on_link", n, start, hits);
+
+    close(sockfd);
+}
+
+int main(int argc, char **argv)
+{
+    int bench = 0;
+    int c;
+
+    while ((c = getopt(argc, argv, "b:")) != -1) {
+        switch (c) {
+        case 'b': bench = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-b count]\n", argv[0]);
+            exit(1);
+        }
+    }
+
+    if (bench > 0) {
+        benchmark(bench);
+        return 0;
+    }
+
+    // 后台线程更新接口表, 这里只比较代号
+    InterfaceTable &table = InterfaceTable::instance();
+    uint64_t generation = 0;
+    for ( ; ; ) {
+        if (table.generation() != generation) {
+            const InterfaceSnapshot &snapshot = table.current();
+            generation = snapshot.generation();
+            print_table(snapshot);
+        }
+        usleep(100000);
+    }
+}
@@ -0,0 +1,192 @@
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "err_quit.hpp"
+#include "latency_histogram.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+/**
+ * ipcbench: 父子进程之间做请求-应答(ping-pong), 报告往返延迟百分位数
+ *
+ * 传输方式:
+ *   unix: UnixStreamSocket::pair(socketpair), 每条消息两次系统调用, 两次拷贝
+ *   shm:  ShmChannel::pair, 共享内存环形缓冲区, 只在对端睡眠时才用futex唤醒
+ *
+ * 两端都通过CommunicatingSocket的send/recv访问, 测试的是同一套处理代码.
+ *
+ * 发送方先发完整条消息再读应答, 所以一条消息必须能完整放进单向的缓冲区, 否则两端都阻塞在发送上:
+ * shm的环形缓冲区按消息长度分配; unix的发送缓冲区按消息长度设置, 受net.core.wmem_max限制,
+ * 仍然放不下时拒绝运行.
+ */
+
+enum Transport { TRANSPORT_UNIX, TRANSPORT_SHM };
+
+struct BenchConfig {
+    Transport transport = TRANSPORT_UNIX;
+    int size = 64;              // 消息长度
+    int count = 100000;         // 往返次数
+    int spin = -1;              // shm: 睡眠前的自旋次数, -1表示使用默认值
+};
+
+static inline uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void recv_full(CommunicatingSocket &sock, char *buf, int len)
+{
+    while (len > 0) {
+        int n = sock.recv(buf, len);
+        if (n == 0)
+            err_quit("peer closed");
+        buf += n;
+        len -= n;
+    }
+}
+
+// 子进程: 原样返回每条消息
+static void echo_loop(CommunicatingSocket &sock, int size)
+{
+    std::vector<char> buf(size);
+    for ( ; ; ) {
+        int n = sock.recv(buf.data(), size);
+        if (n == 0)
+            return;
+        sock.sendAll(buf.data(), n);
+    }
+}
+
+static void ping_loop(CommunicatingSocket &sock, const BenchConfig &cfg, LatencyHistogram &latency)
+{
+    std::vector<char> buf(cfg.size, 'x');
+    for (int i = 0; i < cfg.count; i++) {
+        uint64_t start = now_ns();
+        sock.sendAll(buf.data(), cfg.size);
+        recv_full(sock, buf.data(), cfg.size);
+        latency.add(now_ns() - start);
+    }
+}
+
+// 设置socketpair一端的发送缓冲区, 返回内核实际可用的字节数(getsockopt的值包含了一倍的记账开销)
+static int fit_send_buffer(UnixStreamSocket &sock, int size)
+{
+    int sndbuf;
+    socklen_t len = sizeof(sndbuf);
+    if (getsockopt(sock.getNativeHandle(), SOL_SOCKET, SO_SNDBUF, &sndbuf, &len) != 0)
+        err_quit("getsockopt SO_SNDBUF error");
+    if (sndbuf / 2 >= size)
+        return sndbuf / 2;
+
+    sock.setSendBufferSize(size);
+    len = sizeof(sndbuf);
+    if (getsockopt(sock.getNativeHandle(), SOL_SOCKET, SO_SNDBUF, &sndbuf, &len) != 0)
+        err_quit("getsockopt SO_SNDBUF error");
+    return sndbuf / 2;
+}
+
+// fork之后只关闭本进程中的描述符, 见samples/unixdomain/tcpserv_prefork.cpp
+static void close_local(Socket &sock)
+{
+    ::close(sock.release());
+}
+
+template <typename Channel>
+static double run(Channel &parent, Channel &child, const BenchConfig &cfg, LatencyHistogram &latency)
+{
+    pid_t pid = fork();
+    if (pid < 0) {
+        err_quit("fork error");
+    } else if (pid == 0) {      /* child process */
+        close_local(parent);
+        echo_loop(child, cfg.size);
+        exit(0);
+    }
+    close_local(child);
+
+    uint64_t start = now_ns();
+    ping_loop(parent, cfg, latency);
+    double seconds = (now_ns() - start) / 1e9;
+
+    parent.close();
+    waitpid(pid, NULL, 0);
+    return seconds;
+}
+
+static void usage()
+{
+    err_quit("usage: ipcbench [-m unix|shm] [-s msg_size] [-n round_trips] [-p spin_count]");
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig cfg;
+    int         c;
+
+    while ((c = getopt(argc, argv, "m:s:n:p:")) != -1) {
+        switch (c) {
+        case 'm':
+            if (strcmp(optarg, "unix") == 0)
+                cfg.transport = TRANSPORT_UNIX;
+            else if (strcmp(optarg, "shm") == 0)
+                cfg.transport = TRANSPORT_SHM;
+            else
+                usage();
+            break;
+        case 's': cfg.size = atoi(optarg); break;
+        case 'n': cfg.count = atoi(optarg); break;
+        case 'p': cfg.spin = atoi(optarg); break;
+        default:
+            usage();
+        }
+    }
+    if (cfg.size < 1 || cfg.count < 1)
+        usage();
+
+    LatencyHistogram latency;
+    double seconds;
+    if (cfg.transport == TRANSPORT_UNIX) {
+        UnixStreamSocket parent, child;
+        UnixStreamSocket::pair(parent, child);
+        int room = std::min(fit_send_buffer(parent, cfg.size), fit_send_buffer(child, cfg.size));
+        if (room < cfg.size)
+            err_quit("message size %d exceeds the socket send buffer (%d bytes, see net.core.wmem_max)",
+                    cfg.size, room);
+        seconds = run(parent, child, cfg, latency);
+    } else {
+        ShmChannel parent, child;
+        ShmChannel::pair(parent, child, std::max((size_t) cfg.size, ShmChannel::DEFAULT_RING_SIZE));
+        if (parent.getRingSize() < (size_t) cfg.size)
+            err_quit("message size %d exceeds the ring size (%zu bytes)", cfg.size, parent.getRingSize());
+        if (cfg.spin >= 0) {
+            parent.setSpinCount(cfg.spin);
+            child.setSpinCount(cfg.spin);
+        }
+        seconds = run(parent, child, cfg, latency);
+    }
+
+    std::vector<uint64_t> hist(LatencyHistogram::BUCKETS);
+    latency.accumulate(hist);
+    uint64_t total = cfg.count;
+
+    printf("transport: %s, message size: %d, round trips: %d\n",
+            cfg.transport == TRANSPORT_UNIX ? "unix" : "shm", cfg.size, cfg.count);
+    printf("%.0f round trips/s, mean %.2f us\n", total / seconds, seconds * 1e6 / total);
+    printf("latency us: p50 %.2f p90 %.2f p99 %.2f p99.9 %.2f\n",
+            percentile(hist, total, 0.50) / 1e3, percentile(hist, total, 0.90) / 1e3,
+            percentile(hist, total, 0.99) / 1e3, percentile(hist, total, 0.999) / 1e3);
+
+    return 0;
+}
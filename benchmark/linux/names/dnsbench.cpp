@@ -0,0 +1,305 @@
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "err_quit.hpp"
+#include "latency_histogram.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+/**
+ * dnsbench: 按不同的解析方式反复解析一组名字, 报告每秒解析次数和延迟百分位数
+ *
+ * 解析方式:
+ *   blocking: DNSResolver::query, 每次都调用getaddrinfo
+ *   cached:   DNSResolver::query, 开启进程内缓存
+ *   async:    DNSResolver::queryAsync(getaddrinfo_a), 每个线程保持window个未完成的请求
+ *   stub:     StubDNSResolver, 直接向域名服务器发送A/AAAA查询
+ *   batch:    DNSBatchQuery, 每次提交window个名字, 全部完成(或超时取消)后再提交下一批
+ */
+
+enum ResolveMode { MODE_BLOCKING, MODE_CACHED, MODE_ASYNC, MODE_STUB, MODE_BATCH };
+
+struct BenchConfig {
+    ResolveMode mode = MODE_BLOCKING;
+    int threads = 1;
+    int duration = 5;           // 秒
+    int window = 16;            // async: 每个线程未完成的请求数; batch: 每批的名字数
+    int cacheTtl = 30000;       // cached: 缓存有效期, 毫秒
+    std::string server;         // stub: 域名服务器ip:port, 空表示使用/etc/resolv.conf
+    std::vector<std::string> names;
+};
+
+struct ThreadStats {
+    std::atomic<uint64_t> lookups{0};
+    std::atomic<uint64_t> errors{0};
+    LatencyHistogram      latency;
+    char pad[64];
+};
+
+static std::atomic<bool> stop_flag(false);
+
+static inline uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void record(ThreadStats &stats, uint64_t start, bool ok)
+{
+    stats.latency.add(now_ns() - start);
+    stats.lookups.fetch_add(1, std::memory_order_relaxed);
+    if (!ok)
+        stats.errors.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Resolver>
+static void resolve_loop(int index, const BenchConfig &cfg, Resolver &resolver, ThreadStats &stats)
+{
+    size_t i = index;
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        const std::string &name = cfg.names[i++ % cfg.names.size()];
+        uint64_t start = now_ns();
+        bool ok = true;
+        try {
+            resolver.query(name.c_str(), "80", TransportLayerType::TCP);
+        } catch (const SocketException &) {
+            ok = false;
+        }
+        record(stats, start, ok);
+    }
+}
+
+/**
+ * 异步模式: 线程保持window个请求在途, 回调中只记录结果并通知, 不在回调中发起下一个:
+ * 数字地址和缓存命中时回调在queryAsync中同步调用, 在回调中提交会无限递归
+ */
+struct AsyncLoop {
+    const BenchConfig &cfg;
+    ThreadStats &stats;
+    DNSResolver resolver;
+    size_t next;
+    std::mutex mutex;
+    std::condition_variable cond;
+    int outstanding = 0;        // 由mutex保护
+
+    AsyncLoop(int index, const BenchConfig &cfg, ThreadStats &stats):
+        cfg(cfg), stats(stats), next(index)
+    {
+    }
+
+    void finish(uint64_t start, bool ok)
+    {
+        record(stats, start, ok);
+        std::lock_guard<std::mutex> lock(mutex);
+        outstanding--;
+        cond.notify_one();
+    }
+
+    void submit()
+    {
+        const std::string &name = cfg.names[next++ % cfg.names.size()];
+        uint64_t start = now_ns();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            outstanding++;
+        }
+        try {
+            resolver.queryAsync(name.c_str(), "80", TransportLayerType::TCP,
+                    [this, start](DNSResolver::ResultRange, SocketError ec) {
+                        finish(start, ec.type == SocketError::no_error);
+                    });
+        } catch (const SocketException &) {
+            finish(start, false);
+        }
+    }
+
+    void run()
+    {
+        while (!stop_flag.load(std::memory_order_relaxed)) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [this]() { return outstanding < cfg.window; });
+            }
+            submit();
+        }
+
+        // 等待在途的请求完成, 回调引用了这个对象
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this]() { return outstanding == 0; });
+    }
+};
+
+/**
+ * 批量模式: 一批的延迟是从提交到wait返回, 每个名字都记为这一批的延迟
+ */
+static void batch_loop(int index, const BenchConfig &cfg, ThreadStats &stats)
+{
+    const int BATCH_TIMEOUT_MS = 2000;
+    size_t i = index;
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        DNSBatchQuery batch(TransportLayerType::TCP);
+        for (int k = 0; k < cfg.window; k++)
+            batch.add(cfg.names[i++ % cfg.names.size()].c_str(), "80");
+
+        uint64_t start = now_ns();
+        try {
+            batch.submit();
+        } catch (const SocketException &) {
+            for (size_t k = 0; k < batch.size(); k++)
+                record(stats, start, false);
+            continue;
+        }
+        batch.wait(BATCH_TIMEOUT_MS);
+        for (size_t k = 0; k < batch.size(); k++)
+            record(stats, start, batch.getError(k).type == SocketError::no_error);
+    }
+}
+
+static void bench_thread(int index, const BenchConfig &cfg, ThreadStats &stats)
+{
+    switch (cfg.mode) {
+    case MODE_BLOCKING:
+    case MODE_CACHED: {
+        DNSResolver resolver;
+        resolve_loop(index, cfg, resolver, stats);
+        break;
+    }
+    case MODE_STUB: {
+        std::unique_ptr<StubDNSResolver> resolver;
+        if (cfg.server.empty()) {
+            resolver.reset(new StubDNSResolver);
+        } else {
+            StubDNSResolver::Config config;
+            size_t colon = cfg.server.rfind(':');
+            std::string ip = cfg.server.substr(0, colon);
+            int port = colon == std::string::npos ? 53 : atoi(cfg.server.c_str() + colon + 1);
+            config.nameservers.push_back(SocketAddress(ip.c_str(), port));
+            config.timeoutMs = 1000;
+            resolver.reset(new StubDNSResolver(config));
+        }
+        resolve_loop(index, cfg, *resolver, stats);
+        break;
+    }
+    case MODE_ASYNC: {
+        AsyncLoop loop(index, cfg, stats);
+        loop.run();
+        break;
+    }
+    case MODE_BATCH:
+        batch_loop(index, cfg, stats);
+        break;
+    }
+}
+
+static const char *mode_name(ResolveMode mode)
+{
+    static const char *names[] = { "blocking", "cached", "async", "stub", "batch" };
+    return names[mode];
+}
+
+static void usage()
+{
+    err_quit("usage: dnsbench [-m blocking|cached|async|stub|batch] [-t threads] [-d seconds] "
+            "[-w window] [-c cache_ttl_ms] [-s server:port] [-f names_file] [name ...]");
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig cfg;
+    int         c;
+
+    while ((c = getopt(argc, argv, "m:t:d:w:c:s:f:")) != -1) {
+        switch (c) {
+        case 'm':
+            if (strcmp(optarg, "blocking") == 0)
+                cfg.mode = MODE_BLOCKING;
+            else if (strcmp(optarg, "cached") == 0)
+                cfg.mode = MODE_CACHED;
+            else if (strcmp(optarg, "async") == 0)
+                cfg.mode = MODE_ASYNC;
+            else if (strcmp(optarg, "stub") == 0)
+                cfg.mode = MODE_STUB;
+            else if (strcmp(optarg, "batch") == 0)
+                cfg.mode = MODE_BATCH;
+            else
+                usage();
+            break;
+        case 't': cfg.threads = atoi(optarg); break;
+        case 'd': cfg.duration = atoi(optarg); break;
+        case 'w': cfg.window = atoi(optarg); break;
+        case 'c': cfg.cacheTtl = atoi(optarg); break;
+        case 's': cfg.server = optarg; break;
+        case 'f': {
+            std::ifstream in(optarg);
+            if (!in)
+                err_quit("can't open %s", optarg);
+            std::string line;
+            while (std::getline(in, line)) {
+                if (!line.empty() && line[0] != '#')
+                    cfg.names.push_back(line);
+            }
+            break;
+        }
+        default:
+            usage();
+        }
+    }
+
+    for (int i = optind; i < argc; i++)
+        cfg.names.push_back(argv[i]);
+    if (cfg.names.empty())
+        usage();
+    if (cfg.threads < 1)
+        cfg.threads = 1;
+    if (cfg.window < 1)
+        cfg.window = 1;
+
+    if (cfg.mode == MODE_CACHED)
+        DNSResolver::enableCache(cfg.cacheTtl);
+
+    std::vector<ThreadStats> stats(cfg.threads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < cfg.threads; i++)
+        threads.emplace_back(bench_thread, i, std::cref(cfg), std::ref(stats[i]));
+
+    uint64_t start = now_ns();
+    sleep(cfg.duration);
+    stop_flag = true;
+    for (auto &t: threads)
+        t.join();
+    double seconds = (now_ns() - start) / 1e9;
+
+    uint64_t lookups = 0, errors = 0;
+    std::vector<uint64_t> hist(LatencyHistogram::BUCKETS);
+    for (auto &s: stats) {
+        lookups += s.lookups;
+        errors += s.errors;
+        s.latency.accumulate(hist);
+    }
+
+    printf("mode: %s, threads: %d, names: %d\n", mode_name(cfg.mode), cfg.threads, (int) cfg.names.size());
+    printf("total: %llu lookups, %.0f lookups/s, errors: %llu\n",
+            (unsigned long long) lookups, lookups / seconds, (unsigned long long) errors);
+    if (lookups > 0) {
+        printf("latency us: p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f\n",
+                percentile(hist, lookups, 0.50) / 1e3, percentile(hist, lookups, 0.90) / 1e3,
+                percentile(hist, lookups, 0.99) / 1e3, percentile(hist, lookups, 0.999) / 1e3);
+    }
+
+    return 0;
+}
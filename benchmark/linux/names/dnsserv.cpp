@@ -0,0 +1,236 @@
+#include <unistd.h>
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "err_quit.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+/**
+ * dnsserv: 供dnsbench使用的本地DNS服务器
+ *
+ * 对任何名字都给出确定的应答, 地址由名字的哈希值生成:
+ *   A: 10.x.y.z, AAAA: fd00::x:y:z
+ * 第一个标签以"nx"开头的名字返回NXDOMAIN, 以"tc"开头的名字在UDP上返回截断应答(TC),
+ * 在TCP上返回完整应答.
+ */
+
+struct ServerConfig {
+    int threads = 1;
+    int delayUs = 0;        // 每个应答前的人为延迟, 模拟上游解析时间
+};
+
+static std::atomic<uint64_t> udp_queries(0);
+static std::atomic<uint64_t> tcp_queries(0);
+
+static uint32_t hash_name(const unsigned char *name, int len)
+{
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        h ^= (unsigned char) tolower(name[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * 根据查询构造应答, 写到out中, 返回应答长度; 查询格式错误返回-1
+ */
+static int make_answer(const unsigned char *query, int len, bool udp, unsigned char *out, int outLen)
+{
+    if (len < 12 || (query[2] & 0x80) != 0)
+        return -1;
+
+    // 问题段: 名字 + QTYPE + QCLASS
+    int pos = 12;
+    while (pos < len && query[pos] != 0) {
+        if ((query[pos] & 0xc0) != 0)
+            return -1;
+        pos += 1 + query[pos];
+    }
+    if (pos + 5 > len)
+        return -1;
+    int nameEnd = pos + 1;
+    int qend = nameEnd + 4;
+    int qtype = (query[nameEnd] << 8) | query[nameEnd + 1];
+    const unsigned char *label = query + 13;
+    int labelLen = query[12];
+
+    if (qend + 16 > outLen)
+        return -1;
+    memcpy(out, query, qend);
+    out[2] = 0x80 | (query[2] & 0x01);  // QR, 保留RD
+    out[3] = 0x80;                      // RA
+    memset(out + 6, 0, 6);              // ANCOUNT, NSCOUNT, ARCOUNT
+
+    if (labelLen >= 2 && strncasecmp((const char *) label, "nx", 2) == 0) {
+        out[3] |= 3;                    // NXDOMAIN
+        return qend;
+    }
+    if (udp && labelLen >= 2 && strncasecmp((const char *) label, "tc", 2) == 0) {
+        out[2] |= 0x02;                 // TC
+        return qend;
+    }
+
+    uint32_t h = hash_name(query + 12, nameEnd - 12);
+    unsigned char rdata[16];
+    int rdlen;
+    if (qtype == 1) {
+        rdata[0] = 10;
+        rdata[1] = h >> 16;
+        rdata[2] = h >> 8;
+        rdata[3] = h;
+        rdlen = 4;
+    } else if (qtype == 28) {
+        memset(rdata, 0, 16);
+        rdata[0] = 0xfd;
+        rdata[13] = h >> 16;
+        rdata[14] = h >> 8;
+        rdata[15] = h;
+        rdlen = 16;
+    } else {
+        return qend;                    // 其他类型: 没有数据
+    }
+
+    unsigned char *p = out + qend;
+    p[0] = 0xc0;                        // 指向问题段中的名字
+    p[1] = 12;
+    p[2] = 0;
+    p[3] = (unsigned char) qtype;
+    p[4] = 0;
+    p[5] = 1;                           // IN
+    p[6] = 0;
+    p[7] = 0;
+    p[8] = 0;
+    p[9] = 60;                          // TTL
+    p[10] = 0;
+    p[11] = (unsigned char) rdlen;
+    memcpy(p + 12, rdata, rdlen);
+    out[7] = 1;                         // ANCOUNT
+    return qend + 12 + rdlen;
+}
+
+static void udp_server(const ServerConfig &cfg, const SocketAddress &addr)
+{
+    UDPSocket sock;
+    sock.open(addr.getNetworkLayerType(), TransportLayerType::UDP);
+    if (cfg.threads > 1)
+        sock.setReusePort(true);
+    sock.setReceiveBufferSize(4 * 1024 * 1024);
+    sock.bind(addr);
+
+    unsigned char query[1500], answer[1500];
+    SocketAddress client;
+    for ( ; ; ) {
+        int n = sock.recvFrom((char *) query, sizeof(query), client);
+        int m = make_answer(query, n, true, answer, sizeof(answer));
+        if (m < 0)
+            continue;
+        if (cfg.delayUs > 0)
+            usleep(cfg.delayUs);
+        sock.sendTo((const char *) answer, m, client);
+        udp_queries.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static bool recv_exactly(TCPSocket &sock, unsigned char *buf, int len)
+{
+    while (len > 0) {
+        int n = sock.recv((char *) buf, len);
+        if (n <= 0)
+            return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+static void tcp_session(std::shared_ptr<TCPSocket> sock, const ServerConfig &cfg)
+{
+    unsigned char query[65536], answer[2 + 1500];
+    try {
+        for ( ; ; ) {
+            unsigned char lenbuf[2];
+            if (!recv_exactly(*sock, lenbuf, 2))
+                return;
+            int len = (lenbuf[0] << 8) | lenbuf[1];
+            if (!recv_exactly(*sock, query, len))
+                return;
+            int m = make_answer(query, len, false, answer + 2, sizeof(answer) - 2);
+            if (m < 0)
+                return;
+            if (cfg.delayUs > 0)
+                usleep(cfg.delayUs);
+            answer[0] = m >> 8;
+            answer[1] = m;
+            sock->sendAll((const char *) answer, m + 2);
+            tcp_queries.fetch_add(1, std::memory_order_relaxed);
+        }
+    } catch (const SocketException &) {
+    }
+}
+
+static void tcp_server(const ServerConfig &cfg, const SocketAddress &addr)
+{
+    TCPServerSocket server(addr);
+    for ( ; ; )
+        std::thread(tcp_session, server.accept(), std::cref(cfg)).detach();
+}
+
+int main(int argc, char **argv)
+{
+    ServerConfig   cfg;
+    unsigned short port = 5353;
+    std::string    ip = "127.0.0.1";
+    int            c;
+
+    while ((c = getopt(argc, argv, "t:D:")) != -1) {
+        switch (c) {
+        case 't': cfg.threads = atoi(optarg); break;
+        case 'D': cfg.delayUs = atoi(optarg); break;
+        default:
+            err_quit("usage: dnsserv [-t threads] [-D delay_us] [ <IPaddress> ] [port]");
+        }
+    }
+
+    if (argc - optind == 1) {
+        port = atoi(argv[optind]);
+    } else if (argc - optind == 2) {
+        ip = argv[optind];
+        port = atoi(argv[optind + 1]);
+    } else if (argc - optind != 0) {
+        err_quit("usage: dnsserv [-t threads] [-D delay_us] [ <IPaddress> ] [port]");
+    }
+
+    if (cfg.threads < 1)
+        cfg.threads = 1;
+
+    SocketAddress addr(ip.c_str(), port);
+    for (int i = 0; i < cfg.threads; i++)
+        std::thread(udp_server, std::cref(cfg), std::cref(addr)).detach();
+    std::thread(tcp_server, std::cref(cfg), std::cref(addr)).detach();
+
+    uint64_t lastUdp = 0, lastTcp = 0;
+    for ( ; ; ) {
+        sleep(1);
+        uint64_t udp = udp_queries.load(std::memory_order_relaxed);
+        uint64_t tcp = tcp_queries.load(std::memory_order_relaxed);
+        if (udp != lastUdp || tcp != lastTcp) {
+            printf("dnsserv: %llu udp qps, %llu tcp qps\n",
+                    (unsigned long long) (udp - lastUdp), (unsigned long long) (tcp - lastTcp));
+            fflush(stdout);
+        }
+        lastUdp = udp;
+        lastTcp = tcp;
+    }
+}
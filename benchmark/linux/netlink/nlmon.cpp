@@ -0,0 +1,144 @@
+#include <net/if.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <vector>
+
+#include "err_quit.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+/**
+ * nlmon: netlink_listen.cpp的NetlinkSocket版本
+ *
+ * 先dump当前的网络接口, 地址和路由, 然后监听变化并打印;
+ * -b N: 只重复dump N次, 报告每次dump(收包 + 遍历 + 解析)的耗时
+ */
+
+static inline uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static const char *ntop(int family, const void *addr, char *buf, size_t len)
+{
+    if (addr == NULL)
+        return "-";
+    return inet_ntop(family, addr, buf, len) ? buf : "?";
+}
+
+static void print_message(const NetlinkMessage &msg)
+{
+    LinkMessage link;
+    AddressMessage addr;
+    RouteMessage route;
+    char tmp[INET6_ADDRSTRLEN], tmp2[INET6_ADDRSTRLEN];
+
+    if (link.parse(msg)) {
+        printf("%s: %d %s %s mtu %u\n", link.isNew ? "NEWLINK" : "DELLINK", link.index,
+                link.name ? link.name : "?", (link.flags & IFF_UP) ? "up" : "down", link.mtu);
+    } else if (addr.parse(msg)) {
+        sockaddr_storage ss;
+        char buf[ADDRESS_PORT_STRLEN];
+        socklen_t salen = addr.toSockaddr(&ss);
+        if (salen == 0 || format_address((sockaddr *) &ss, salen, buf, sizeof(buf)) == 0)
+            strcpy(buf, "?");
+        printf("%s: %d %s/%d %s\n", addr.isNew ? "NEWADDR" : "DELADDR", addr.index,
+                buf, addr.prefixLen, addr.label ? addr.label : "");
+    } else if (route.parse(msg)) {
+        printf("%s: table %u %s/%d via %s dev %d\n", route.isNew ? "NEWROUTE" : "DELROUTE", route.table,
+                route.dst ? ntop(route.family, route.dst, tmp, sizeof(tmp)) : "default", route.dstLen,
+                ntop(route.family, route.gateway, tmp2, sizeof(tmp2)), route.oif);
+    } else if (msg.isError() && msg.error() != 0) {
+        printf("error: %s\n", strerror(msg.error()));
+    }
+}
+
+// 接收一次dump的所有应答, 返回消息个数
+static int recv_dump(NetlinkSocket &sock, uint32_t seq, std::vector<char> &buf, bool print)
+{
+    const int BATCH = 8;
+    int lens[BATCH];
+    int count = 0;
+    for ( ; ; ) {
+        int n = sock.recvBatch(buf.data(), NetlinkSocket::RECV_BUFFER_SIZE, BATCH, lens);
+        for (int i = 0; i < n; i++) {
+            for (NetlinkMessage msg: NetlinkMessages(buf.data() + i * NetlinkSocket::RECV_BUFFER_SIZE, lens[i])) {
+                if (msg.seq() != seq)
+                    continue;
+                if (msg.isDone())
+                    return count;
+                if (msg.isError()) {
+                    print_message(msg);
+                    return count;
+                }
+                count++;
+                if (print) {
+                    print_message(msg);
+                } else {
+                    LinkMessage link;
+                    AddressMessage addr;
+                    RouteMessage route;
+                    if (!link.parse(msg) && !addr.parse(msg) && !route.parse(msg))
+                        printf("unexpected message type %d\n", msg.type());
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int bench = 0;
+    int c;
+
+    while ((c = getopt(argc, argv, "b:")) != -1) {
+        switch (c) {
+        case 'b': bench = atoi(optarg); break;
+        default:
+            err_quit("usage: nlmon [-b dump_rounds]");
+        }
+    }
+
+    std::vector<char> buf(8 * NetlinkSocket::RECV_BUFFER_SIZE);
+    const uint16_t dumps[] = { RTM_GETLINK, RTM_GETADDR, RTM_GETROUTE };
+
+    if (bench > 0) {
+        NetlinkSocket sock(0);
+        for (uint16_t type: dumps) {
+            int messages = 0;
+            uint64_t start = now_ns();
+            for (int i = 0; i < bench; i++)
+                messages += recv_dump(sock, sock.requestDump(type), buf, false);
+            double us = (now_ns() - start) / 1e3 / bench;
+            printf("dump type %d: %d messages, %.1f us per dump, %.0f ns per message\n",
+                    type, messages / bench, us, messages ? us * 1e3 * bench / messages : 0.0);
+        }
+        return 0;
+    }
+
+    // 先加入多播组再dump, dump期间发生的变化不会丢失(可能重复)
+    NetlinkSocket sock(NetlinkSocket::GROUP_LINK |
+            NetlinkSocket::GROUP_IPV4_ADDRESS | NetlinkSocket::GROUP_IPV6_ADDRESS |
+            NetlinkSocket::GROUP_IPV4_ROUTE | NetlinkSocket::GROUP_IPV6_ROUTE);
+    NetlinkSocket dumpSock(0);
+    for (uint16_t type: dumps)
+        recv_dump(dumpSock, dumpSock.requestDump(type), buf, true);
+    fflush(stdout);
+
+    for ( ; ; ) {
+        int n = sock.recv(buf.data(), NetlinkSocket::RECV_BUFFER_SIZE);
+        for (NetlinkMessage msg: NetlinkMessages(buf.data(), n))
+            print_message(msg);
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <memory>
+#include <vector>
+
+#include "err_quit.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+/**
+ * sockstat: 获取一组TCP连接的rtt, 重传次数和队列长度的几种方式
+ *
+ *   getsockopt 对每个连接调用getsockopt(TCP_INFO)
+ *   sock_diag  SocketDiag一次dump(按对端端口过滤), 再按inode对应到连接上
+ *   ss         popen("ss -tinm ..."), 只统计耗时, 不解析输出
+ *
+ * 在127.0.0.1上建立-n个连接(默认100), 每种方式重复-r次(默认100), 报告每轮的耗时
+ */
+
+static inline uint64_t now_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void report(const char *name, int rounds, uint64_t start, int matched)
+{
+    double us = (now_ns() - start) / 1e3 / rounds;
+    printf("%-12s %10.1f us per round (%d connections)\n", name, us, matched);
+}
+
+static void print_entry(const SocketDiagEntry &entry)
+{
+    char local[ADDRESS_PORT_STRLEN], remote[ADDRESS_PORT_STRLEN];
+    entry.localAddress.format(local, sizeof(local));
+    entry.remoteAddress.format(remote, sizeof(remote));
+    printf("%s -> %s inode %u state %d rq %u wq %u", local, remote, entry.inode, entry.state,
+            entry.recvQueue, entry.sendQueue);
+    if (entry.hasTcpInfo)
+        printf(" rtt %u/%u us retrans %u cwnd %u", entry.tcpInfo.tcpi_rtt, entry.tcpInfo.tcpi_rttvar,
+                entry.tcpInfo.tcpi_total_retrans, entry.tcpInfo.tcpi_snd_cwnd);
+    if (entry.hasMemInfo)
+        printf(" rmem %u wmem %u", entry.memInfo[SK_MEMINFO_RMEM_ALLOC], entry.memInfo[SK_MEMINFO_WMEM_ALLOC]);
+    if (entry.congestion[0] != '\0')
+        printf(" %s", entry.congestion);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    int conns = 100;
+    int rounds = 100;
+    int c;
+
+    while ((c = getopt(argc, argv, "n:r:")) != -1) {
+        switch (c) {
+        case 'n': conns = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        default:
+            fprintf(stderr, "usage: %s [-n connections] [-r rounds]\n", argv[0]);
+            exit(1);
+        }
+    }
+
+    TCPServerSocket server(SocketAddress("127.0.0.1", 0));
+    uint16_t port = std::get<1>(server.getLocalAddress().getAddressPort());
+
+    std::vector<std::shared_ptr<TCPSocket>> clients;
+    std::vector<std::shared_ptr<TCPSocket>> accepted;
+    std::vector<uint32_t> inodes;       // 建立连接时取一次inode
+    for (int i = 0; i < conns; i++) {
+        clients.push_back(std::make_shared<TCPSocket>(SocketAddress("127.0.0.1", port)));
+        accepted.push_back(server.accept());
+        inodes.push_back(SocketDiag::getInode(*clients.back()));
+        clients.back()->sendAll("x", 1);    // 让tcp_info中有rtt样本
+    }
+
+    uint64_t start = now_ns();
+    int matched = 0;
+    for (int r = 0; r < rounds; r++) {
+        matched = 0;
+        for (auto &client: clients) {
+            tcp_info info;
+            socklen_t len = sizeof(info);
+            if (getsockopt(client->getNativeHandle(), IPPROTO_TCP, TCP_INFO, &info, &len) == 0)
+                matched++;
+        }
+    }
+    report("getsockopt", rounds, start, matched);
+
+    SocketDiag diag;
+    SocketDiagQuery query;
+    query.remotePort = port;
+    query.states = 1 << TCP_ESTABLISHED;
+    query.extensions = SocketDiag::EXT_TCP_INFO | SocketDiag::EXT_MEMINFO;
+    SocketDiagResult result;
+    start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        result.clear();
+        diag.query(query, result);
+        matched = 0;
+        for (uint32_t inode: inodes)
+            matched += result.findByInode(inode) != NULL;
+    }
+    report("sock_diag", rounds, start, matched);
+
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "ss -tinm state established '( dport = :%u )' 2>/dev/null", port);
+    int ssRounds = rounds < 10 ? rounds : 10;
+    start = now_ns();
+    for (int r = 0; r < ssRounds; r++) {
+        FILE *fp = popen(cmd, "r");
+        if (fp == NULL)
+            err_quit("popen error");
+        // 每个连接一行地址, 一行缩进的tcp_info; 去掉表头
+        char line[1024];
+        matched = -1;
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (line[0] != ' ' && line[0] != '\t')
+                matched++;
+        }
+        pclose(fp);
+    }
+    report("ss", ssRounds, start, matched);
+
+    const SocketDiagEntry *entry = result.find(*clients[0]);
+    if (entry == NULL)
+        err_quit("connection not found in sock_diag result");
+    print_entry(*entry);
+
+    return 0;
+}
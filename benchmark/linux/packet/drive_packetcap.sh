@@ -0,0 +1,11 @@
+#!/usr/bin/env bash
+
+# 需要CAP_NET_RAW权限: 在lo上抓包, 同时用udpblaster制造流量
+SRV_PORT=$(($RANDOM + 1024))
+
+../udpcliserv/udpblaster -m batch -r 200000 -d 4 127.0.0.1 $SRV_PORT > /dev/null &
+CLI_PID=$!
+
+./packetcap -i lo -t 2 -d 3
+
+wait $CLI_PID
@@ -0,0 +1,102 @@
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "err_quit.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+struct CaptureStats {
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> blocks{0};
+    char pad[64];
+};
+
+static std::atomic<bool> stop_flag(false);
+
+static void capture(const char *ifname, int fanoutGroup, const PacketRingConfig &config,
+        CaptureStats &stats)
+{
+    PacketSocket sock(ifname, config);
+    if (fanoutGroup >= 0)
+        sock.joinFanout(fanoutGroup, PacketSocket::FANOUT_HASH);
+
+    PacketBlock block;
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        if (!sock.nextBlock(block, 100))
+            continue;
+
+        uint64_t bytes = 0;
+        for (const PacketFrame &frame: block)
+            bytes += frame.wireLength;
+
+        stats.packets.fetch_add(block.frameCount(), std::memory_order_relaxed);
+        stats.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        stats.blocks.fetch_add(1, std::memory_order_relaxed);
+        sock.releaseBlock(block);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *ifname = NULL;
+    int         threads = 1;
+    int         duration = 10;
+    int         blockMB = 1;    // 每个线程占用blockMB * blockCount(默认64)MB内存, 高速抓包时可以用-b调大
+    int         c;
+
+    while ((c = getopt(argc, argv, "i:t:d:b:")) != -1) {
+        switch (c) {
+        case 'i': ifname = optarg; break;
+        case 't': threads = atoi(optarg); break;
+        case 'd': duration = atoi(optarg); break;
+        case 'b': blockMB = atoi(optarg); break;
+        default:
+            err_quit("usage: packetcap [-i interface] [-t threads] [-d seconds] [-b block MB]");
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+    if (blockMB < 1)
+        blockMB = 1;
+
+    PacketRingConfig config;
+    config.blockSize = blockMB << 20;
+
+    // 多个线程时加入同一个fanout组, 按流哈希分担报文
+    int fanoutGroup = threads > 1 ? (getpid() & 0xffff) : -1;
+    std::vector<CaptureStats> stats(threads);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+        workers.push_back(std::thread(capture, ifname, fanoutGroup, std::cref(config), std::ref(stats[i])));
+
+    uint64_t lastPackets = 0, lastBytes = 0;
+    for (int sec = 0; sec < duration; sec++) {
+        sleep(1);
+        uint64_t packets = 0, bytes = 0, blocks = 0;
+        for (auto &s: stats) {
+            packets += s.packets.load(std::memory_order_relaxed);
+            bytes += s.bytes.load(std::memory_order_relaxed);
+            blocks += s.blocks.load(std::memory_order_relaxed);
+        }
+        printf("capture: %10llu pps %8.3f Gbps blocks %llu\n",
+                (unsigned long long) (packets - lastPackets), (bytes - lastBytes) * 8 / 1e9,
+                (unsigned long long) blocks);
+        fflush(stdout);
+        lastPackets = packets;
+        lastBytes = bytes;
+    }
+
+    stop_flag = true;
+    for (auto &t: workers)
+        t.join();
+
+    exit(0);
+}
@@ -0,0 +1,163 @@
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "err_quit.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+/**
+ * tcptxstamp: 用TCPSocket::sendSampled/recvTxTimestamp测量TCP发送路径上各阶段的延迟
+ *
+ * 每条消息的最后一个字节有三个发送时间戳: 进入qdisc(SCHEDULED), 交给网卡驱动(SENT),
+ * 收到对端确认(ACKED). 报告 调用sendSampled -> SCHEDULED, SCHEDULED -> SENT,
+ * SENT -> ACKED 的中位数和p99.
+ *
+ *   -s addr:port  发送到已有的接收端; 默认在127.0.0.1上启动一个丢弃数据的接收线程
+ *   -n count      消息个数(默认1000)
+ *   -l len        消息长度(默认1000)
+ *   -i usec       消息间隔(默认100)
+ *   -H            同时请求网卡硬件时间戳(需要网卡支持并已通过SIOCSHWTSTAMP开启)
+ */
+
+static inline int64_t realtime_ns()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+struct Sample {
+    int64_t call = 0;
+    int64_t scheduled = 0;
+    int64_t sent = 0;
+    int64_t sentHardware = 0;
+    int64_t acked = 0;
+};
+
+static void print_stage(const char *name, std::vector<int64_t> &v)
+{
+    if (v.empty()) {
+        printf("%-20s no samples\n", name);
+        return;
+    }
+    std::sort(v.begin(), v.end());
+    printf("%-20s p50 %8.1f us  p99 %8.1f us  (%zu samples)\n", name,
+            v[v.size() / 2] / 1e3, v[v.size() * 99 / 100] / 1e3, v.size());
+}
+
+// 读出错误队列中所有的发送时间戳, 按字节序号对应到消息
+static void drain_timestamps(TCPSocket &sock, std::vector<Sample> &samples, int len)
+{
+    SocketTimestamp ts;
+    while (sock.recvTxTimestamp(ts)) {
+        uint32_t msg = ts.id / len;
+        if (msg >= samples.size())
+            continue;
+        Sample &s = samples[msg];
+        switch (ts.type) {
+        case SocketTimestamp::SCHEDULED: s.scheduled = ts.software; break;
+        case SocketTimestamp::SENT:
+            // 网卡的硬件时间戳在单独的一条消息中, 其中软件时间戳为0, 不能覆盖已有的值
+            if (ts.software != 0)
+                s.sent = ts.software;
+            if (ts.hardware != 0)
+                s.sentHardware = ts.hardware;
+            break;
+        case SocketTimestamp::ACKED: s.acked = ts.software; break;
+        default: break;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *server = NULL;
+    int count = 1000;
+    int len = 1000;
+    int interval = 100;
+    bool hardware = false;
+    int c;
+
+    while ((c = getopt(argc, argv, "s:n:l:i:H")) != -1) {
+        switch (c) {
+        case 's': server = optarg; break;
+        case 'n': count = atoi(optarg); break;
+        case 'l': len = atoi(optarg); break;
+        case 'i': interval = atoi(optarg); break;
+        case 'H': hardware = true; break;
+        default:
+            fprintf(stderr, "usage: %s [-s addr:port] [-n count] [-l len] [-i usec] [-H]\n", argv[0]);
+            exit(1);
+        }
+    }
+    if (count <= 0 || len <= 0)
+        err_quit("invalid count or length");
+
+    std::shared_ptr<TCPServerSocket> listener;
+    std::thread sink;
+    SocketAddress addr;
+    if (server != NULL) {
+        if (!addr.setAddressPort(server))
+            err_quit("invalid address: %s", server);
+    } else {
+        listener = std::make_shared<TCPServerSocket>(SocketAddress("127.0.0.1", 0));
+        addr = listener->getLocalAddress();
+        sink = std::thread([listener]() {
+                    std::shared_ptr<TCPSocket> conn = listener->accept();
+                    char buf[65536];
+                    while (conn->recv(buf, sizeof(buf)) > 0)
+                        ;
+                });
+    }
+
+    TCPSocket sock(addr);
+    sock.enableTxTimestamping(hardware);
+
+    // 序号从enableTxTimestamping开始计数, 第i条消息最后一个字节的序号为(i + 1) * len - 1
+    std::vector<char> msg(len, 'x');
+    std::vector<Sample> samples(count);
+    for (int i = 0; i < count; i++) {
+        samples[i].call = realtime_ns();
+        sock.sendSampled(msg.data(), len);
+        drain_timestamps(sock, samples, len);
+        if (interval > 0)
+            usleep(interval);
+    }
+
+    // 等待最后几条消息的确认
+    for (int i = 0; i < 100 && samples[count - 1].acked == 0; i++) {
+        usleep(1000);
+        drain_timestamps(sock, samples, len);
+    }
+
+    std::vector<int64_t> callToSched, schedToSent, sentToAck, hwSent;
+    for (const Sample &s: samples) {
+        if (s.scheduled != 0)
+            callToSched.push_back(s.scheduled - s.call);
+        if (s.scheduled != 0 && s.sent != 0)
+            schedToSent.push_back(s.sent - s.scheduled);
+        if (s.sent != 0 && s.acked != 0)
+            sentToAck.push_back(s.acked - s.sent);
+        if (s.sentHardware != 0 && s.sent != 0)
+            hwSent.push_back(s.sentHardware - s.sent);
+    }
+    print_stage("call -> scheduled", callToSched);
+    print_stage("scheduled -> sent", schedToSent);
+    print_stage("sent -> acked", sentToAck);
+    if (hardware)
+        print_stage("hw sent - sw sent", hwSent);
+
+    sock.close();
+    if (sink.joinable())
+        sink.join();
+    return 0;
+}
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+
+SRV_PORT=$(($RANDOM + 1024))
+SIZE=${SIZE:-512}
+RATE=${RATE:-0}
+
+for MODE in plain batch gso paced; do
+    echo "==== mode: $MODE, size: $SIZE, rate: $RATE"
+    ./udpsink -T -d 6 127.0.0.1 $SRV_PORT &
+    SRV_PID=$!
+
+    sleep 1
+
+    ./udpblaster -m $MODE -s $SIZE -r $RATE -d 4 127.0.0.1 $SRV_PORT
+
+    wait $SRV_PID
+done
+
+echo "==== per-core: 4 sinks with SO_REUSEPORT, 4 blaster threads"
+./udpsink -t 4 -c -d 6 127.0.0.1 $SRV_PORT &
+SRV_PID=$!
+
+sleep 1
+
+./udpblaster -m batch -t 4 -c -s $SIZE -r $RATE -d 4 127.0.0.1 $SRV_PORT
+
+wait $SRV_PID
+
+echo "==== pooled: 2 receivers into DatagramBufferPool, 2 worker threads"
+./udpsink -t 2 -w 2 -d 6 127.0.0.1 $SRV_PORT &
+SRV_PID=$!
+
+sleep 1
+
+./udpblaster -m batch -t 4 -s $SIZE -r $RATE -d 4 127.0.0.1 $SRV_PORT
+
+wait $SRV_PID
@@ -0,0 +1,32 @@
+#ifndef UNP_UDPBENCH_INC
+#define UNP_UDPBENCH_INC
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief udpblaster发出的每个报文开头的头部, 供udpsink统计丢包, 乱序和延迟
+ */
+struct BenchHeader {
+    uint32_t magic;     // BENCH_MAGIC
+    uint32_t stream;    // 发送流编号: 每个发送线程一个
+    uint64_t seq;       // 流内序号, 从0开始
+    int64_t  sendTime;  // 发送时刻, CLOCK_REALTIME纳秒
+};
+
+const uint32_t BENCH_MAGIC = 0x55445042;    // "UDPB"
+const int MIN_BENCH_SIZE = sizeof(BenchHeader);
+
+/**
+ * @brief 获取当前时间, 与内核接收时间戳使用同一个时钟
+ *
+ * @return CLOCK_REALTIME纳秒
+ */
+inline int64_t realtime_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#endif
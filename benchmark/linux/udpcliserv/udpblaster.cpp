@@ -0,0 +1,228 @@
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+#include "err_quit.hpp"
+#include "udpbench.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+enum SendMode { MODE_PLAIN, MODE_BATCH, MODE_GSO, MODE_PACED };
+
+struct BlasterConfig {
+    SendMode mode = MODE_PLAIN;
+    int      size = 64;         // 报文长度
+    double   rate = 0;          // 总报文速率, 0表示不限速
+    int      batch = 32;        // 每次系统调用的报文个数(batch/gso)
+    int      threads = 1;
+    bool     pin = false;       // 每个线程绑定一个CPU核
+    int      duration = 10;     // 秒
+};
+
+struct ThreadStats {
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> errors{0};
+    char pad[64];               // 避免不同线程的计数器共享cache line
+};
+
+static std::atomic<bool> stop_flag(false);
+
+// 流编号为(pid << 8) | 线程序号, 线程序号只有8位
+static const int MAX_THREADS = 256;
+
+static void pin_to_core(int core)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % sysconf(_SC_NPROCESSORS_ONLN), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void fill_headers(char *buf, int size, int count, uint32_t stream, uint64_t &seq)
+{
+    int64_t now = realtime_now();
+    for (int i = 0; i < count; i++) {
+        BenchHeader *hdr = (BenchHeader *) (buf + i * size);
+        hdr->magic = BENCH_MAGIC;
+        hdr->stream = stream;
+        hdr->seq = seq++;
+        hdr->sendTime = now;
+    }
+}
+
+static void blaster(int index, const BlasterConfig &cfg, const SocketAddress &addr,
+        ThreadStats &stats)
+{
+    if (cfg.pin)
+        pin_to_core(index);
+
+    UDPSocket sock;
+    sock.open(addr.getNetworkLayerType(), TransportLayerType::UDP);
+    sock.setSendBufferSize(4 * 1024 * 1024);
+
+    int batch = (cfg.mode == MODE_BATCH || cfg.mode == MODE_GSO) ? cfg.batch : 1;
+    std::vector<char> buf(cfg.size * batch);
+    uint32_t stream = ((uint32_t) getpid() << 8) | (uint32_t) index;
+    uint64_t seq = 0;
+
+    double rate = cfg.rate / cfg.threads;
+    UDPPacer pacer(sock);
+    if (cfg.mode == MODE_PACED) {
+        if (!sock.enableTxTime())
+            printf("thread %d: SO_TXTIME not supported, pacing in user space\n", index);
+        pacer.setPacketRate(rate);
+    }
+
+    int64_t start = UDPPacer::now();
+    uint64_t sent = 0;
+    while (!stop_flag.load(std::memory_order_relaxed)) {
+        uint64_t first = seq;
+        fill_headers(buf.data(), cfg.size, batch, stream, seq);
+        int n = 0;
+        try {
+            switch (cfg.mode) {
+            case MODE_PLAIN:
+                sock.sendTo(buf.data(), cfg.size, addr);
+                n = 1;
+                break;
+            case MODE_BATCH:
+                n = sock.sendBatch(buf.data(), cfg.size, batch, addr);
+                break;
+            case MODE_GSO:
+                sock.sendSegmented(buf.data(), cfg.size * batch, cfg.size, addr);
+                n = batch;
+                break;
+            case MODE_PACED:
+                pacer.sendTo(buf.data(), cfg.size, addr);
+                n = 1;
+                break;
+            }
+        } catch (const SocketException &e) {
+            stats.errors.fetch_add(1, std::memory_order_relaxed);
+        }
+        seq = first + n;    // 没发出去的序号留给下一轮, 不算作丢包
+        sent += n;
+        stats.packets.fetch_add(n, std::memory_order_relaxed);
+        stats.bytes.fetch_add((uint64_t) n * cfg.size, std::memory_order_relaxed);
+
+        // 非paced模式按批限速: 发得比计划快就睡到计划时间
+        if (rate > 0 && cfg.mode != MODE_PACED) {
+            int64_t due = start + (int64_t) (sent * 1e9 / rate);
+            int64_t wait = due - UDPPacer::now();
+            if (wait > 0) {
+                struct timespec ts = { (time_t) (wait / 1000000000), (long) (wait % 1000000000) };
+                nanosleep(&ts, NULL);
+            }
+        }
+    }
+}
+
+static SendMode parse_mode(const char *s)
+{
+    std::string mode(s);
+    if (mode == "plain")
+        return MODE_PLAIN;
+    if (mode == "batch")
+        return MODE_BATCH;
+    if (mode == "gso")
+        return MODE_GSO;
+    if (mode == "paced")
+        return MODE_PACED;
+    err_quit("unknown mode: %s", s);
+    return MODE_PLAIN;
+}
+
+int main(int argc, char **argv)
+{
+    BlasterConfig  cfg;
+    unsigned short port = SERV_PORT;
+    int            c;
+
+    while ((c = getopt(argc, argv, "m:s:r:b:t:cd:")) != -1) {
+        switch (c) {
+        case 'm': cfg.mode = parse_mode(optarg); break;
+        case 's': cfg.size = atoi(optarg); break;
+        case 'r': cfg.rate = atof(optarg); break;
+        case 'b': cfg.batch = atoi(optarg); break;
+        case 't': cfg.threads = atoi(optarg); break;
+        case 'c': cfg.pin = true; break;
+        case 'd': cfg.duration = atoi(optarg); break;
+        default:
+            err_quit("usage: udpblaster [-m plain|batch|gso|paced] [-s size] [-r pps] "
+                    "[-b batch] [-t threads] [-c] [-d seconds] <IPaddress> [port]");
+        }
+    }
+
+    if (optind != argc - 1 && optind != argc - 2)
+        err_quit("usage: udpblaster [-m plain|batch|gso|paced] [-s size] [-r pps] "
+                "[-b batch] [-t threads] [-c] [-d seconds] <IPaddress> [port]");
+    if (optind == argc - 2)
+        port = atoi(argv[optind + 1]);
+
+    if (cfg.size < MIN_BENCH_SIZE)
+        cfg.size = MIN_BENCH_SIZE;
+    if (cfg.batch < 1)
+        cfg.batch = 1;
+    if (cfg.batch > UDPSocket::MAX_BATCH)
+        cfg.batch = UDPSocket::MAX_BATCH;
+    if (cfg.mode == MODE_GSO && cfg.size * cfg.batch > 65000)
+        cfg.batch = 65000 / cfg.size;   // 一个GSO报文不能超过64KB
+    if (cfg.threads < 1)
+        cfg.threads = 1;
+    if (cfg.threads > MAX_THREADS)
+        err_quit("too many threads: %d (at most %d)", cfg.threads, MAX_THREADS);
+
+    SocketAddress addr(argv[optind], port);
+    std::vector<ThreadStats> stats(cfg.threads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < cfg.threads; i++)
+        threads.push_back(std::thread(blaster, i, std::cref(cfg), std::cref(addr), std::ref(stats[i])));
+
+    uint64_t lastPackets = 0, lastBytes = 0;
+    int64_t  begin = UDPPacer::now(), last = begin;
+    for (int sec = 0; sec < cfg.duration; sec++) {
+        sleep(1);
+        uint64_t packets = 0, bytes = 0, errors = 0;
+        for (auto &s: stats) {
+            packets += s.packets.load(std::memory_order_relaxed);
+            bytes += s.bytes.load(std::memory_order_relaxed);
+            errors += s.errors.load(std::memory_order_relaxed);
+        }
+        int64_t now = UDPPacer::now();
+        double secs = (now - last) / 1e9;
+        printf("send: %10.0f pps %8.3f Gbps errors %llu\n",
+                (packets - lastPackets) / secs, (bytes - lastBytes) * 8 / secs / 1e9,
+                (unsigned long long) errors);
+        fflush(stdout);
+        lastPackets = packets;
+        lastBytes = bytes;
+        last = now;
+    }
+
+    stop_flag = true;
+    for (auto &t: threads)
+        t.join();
+
+    uint64_t packets = 0, bytes = 0;
+    for (auto &s: stats) {
+        packets += s.packets;
+        bytes += s.bytes;
+    }
+    double secs = (UDPPacer::now() - begin) / 1e9;
+    printf("total: %llu packets, %.0f pps, %.3f Gbps\n", (unsigned long long) packets,
+            packets / secs, bytes * 8 / secs / 1e9);
+
+    exit(0);
+}
@@ -0,0 +1,318 @@
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "config.hpp"
+#include "err_quit.hpp"
+#include "udpbench.hpp"
+#include "latency_histogram.hpp"
+#include "mini_socket.hpp"
+
+using namespace mini_socket;
+
+struct SinkConfig {
+    int  threads = 1;
+    bool pin = false;           // 每个线程绑定一个CPU核
+    bool kernelTime = false;    // 使用内核接收时间戳计算延迟
+    int  duration = 10;         // 秒
+    int  batch = 32;            // 每次recvmmsg的报文个数
+    int  workers = 0;           // >0时接收线程把报文收进缓存池, 交给这么多个处理线程统计
+};
+
+struct ThreadStats {
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> lost{0};
+    std::atomic<uint64_t> reordered{0};
+    std::atomic<uint64_t> invalid{0};
+    std::atomic<uint64_t> poolEmpty{0};     // 缓存池耗尽时丢弃的报文
+    LatencyHistogram      latency;
+    char pad[64];
+};
+
+struct StreamState {
+    uint64_t next = 0;          // 期望的下一个序号
+    uint64_t received = 0;
+};
+
+// 一批报文的统计, 累加完后一次性写入ThreadStats
+struct BatchCounters {
+    uint64_t bytes = 0;
+    uint64_t reordered = 0;
+    uint64_t invalid = 0;
+    int64_t  lost = 0;
+};
+
+// 处理线程的输入队列, 接收线程按流编号把报文分给固定的处理线程, 保证流内顺序
+struct WorkQueue {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::vector<DatagramBuffer *> buffers;
+};
+
+// 缓存池中的缓存个数, 大小为MAXDG
+static const int POOL_BUFFERS = 16384;
+static const int MAXDG = 2048;
+
+static void pin_to_core(int core)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % sysconf(_SC_NPROCESSORS_ONLN), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void account(const char *data, int len, int64_t recvTime,
+        std::unordered_map<uint32_t, StreamState> &streams, ThreadStats &stats, BatchCounters &counters)
+{
+    const BenchHeader *hdr = (const BenchHeader *) data;
+    counters.bytes += len;
+    if (len < MIN_BENCH_SIZE || hdr->magic != BENCH_MAGIC) {
+        counters.invalid++;
+        return;
+    }
+
+    // 跳过的序号先记为丢失, 迟到的报文再从丢失中扣除并记为乱序
+    StreamState &st = streams[hdr->stream];
+    if (hdr->seq >= st.next) {
+        counters.lost += hdr->seq - st.next;
+        st.next = hdr->seq + 1;
+    } else {
+        counters.reordered++;
+        counters.lost--;
+    }
+    st.received++;
+
+    int64_t latency = recvTime - hdr->sendTime;
+    stats.latency.add(latency > 0 ? latency : 0);
+}
+
+static void commit(int packets, const BatchCounters &counters, ThreadStats &stats)
+{
+    stats.packets.fetch_add(packets, std::memory_order_relaxed);
+    stats.bytes.fetch_add(counters.bytes, std::memory_order_relaxed);
+    stats.lost.fetch_add(counters.lost, std::memory_order_relaxed);
+    stats.reordered.fetch_add(counters.reordered, std::memory_order_relaxed);
+    stats.invalid.fetch_add(counters.invalid, std::memory_order_relaxed);
+}
+
+static void open_socket(UDPSocket &sock, const SinkConfig &cfg, const SocketAddress &addr)
+{
+    sock.open(addr.getNetworkLayerType(), TransportLayerType::UDP);
+    if (cfg.threads > 1)
+        sock.setReusePort(true);
+    sock.setReceiveBufferSize(8 * 1024 * 1024);
+    sock.bind(addr);
+}
+
+static void sink(int index, const SinkConfig &cfg, const SocketAddress &addr, ThreadStats &stats)
+{
+    if (cfg.pin)
+        pin_to_core(index);
+
+    UDPSocket sock;
+    open_socket(sock, cfg, addr);
+    if (cfg.kernelTime)
+        sock.enableTimestamping();
+
+    std::vector<char> buf(MAXDG * cfg.batch);
+    std::vector<int> lens(cfg.batch);
+    std::vector<SocketTimestamp> ts(cfg.batch);
+    std::unordered_map<uint32_t, StreamState> streams;
+
+    for ( ; ; ) {
+        int n = sock.recvBatch(buf.data(), MAXDG, cfg.batch, lens.data(),
+                cfg.kernelTime ? ts.data() : NULL);
+        int64_t now = realtime_now();
+        BatchCounters counters;
+        for (int i = 0; i < n; i++) {
+            int64_t recvTime = (cfg.kernelTime && ts[i].hasSoftware()) ? ts[i].software : now;
+            account(buf.data() + i * MAXDG, lens[i], recvTime, streams, stats, counters);
+        }
+        commit(n, counters, stats);
+    }
+}
+
+// 接收线程: 每个报文收进缓存池中的一个缓存, 按流编号交给处理线程
+static void pooled_receiver(int index, const SinkConfig &cfg, const SocketAddress &addr,
+        DatagramBufferPool &pool, std::vector<WorkQueue> &queues, ThreadStats &stats)
+{
+    if (cfg.pin)
+        pin_to_core(index);
+
+    UDPSocket sock;
+    open_socket(sock, cfg, addr);
+    DatagramBufferPool::LocalCache cache(pool, cfg.batch * 2);
+    char scratch[MAXDG];
+    SocketAddress source;
+
+    for ( ; ; ) {
+        DatagramBuffer *buffer = cache.acquire();
+        if (buffer == NULL) {
+            // 处理线程跟不上, 缓存池已耗尽: 把报文读出来丢掉, 不让内核队列堆积
+            sock.recvFrom(scratch, sizeof(scratch), source);
+            stats.poolEmpty.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        sock.recvFrom(*buffer);
+        uint32_t stream = buffer->length >= MIN_BENCH_SIZE ?
+            ((const BenchHeader *) buffer->data())->stream : 0;
+        WorkQueue &queue = queues[stream % queues.size()];
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            wasEmpty = queue.buffers.empty();
+            queue.buffers.push_back(buffer);
+        }
+        if (wasEmpty)
+            queue.cond.notify_one();
+    }
+}
+
+// 处理线程: 统计后把缓存还给池, 与获取缓存的接收线程不是同一个线程
+static void pooled_worker(WorkQueue &queue, DatagramBufferPool &pool, ThreadStats &stats)
+{
+    DatagramBufferPool::LocalCache cache(pool);
+    std::vector<DatagramBuffer *> buffers;
+    std::unordered_map<uint32_t, StreamState> streams;
+
+    for ( ; ; ) {
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.cond.wait(lock, [&queue]() { return !queue.buffers.empty(); });
+            buffers.swap(queue.buffers);
+        }
+
+        // 延迟包括在队列中等待的时间
+        int64_t now = realtime_now();
+        BatchCounters counters;
+        for (DatagramBuffer *buffer: buffers) {
+            account(buffer->data(), buffer->length, now, streams, stats, counters);
+            cache.release(buffer);
+        }
+        commit(buffers.size(), counters, stats);
+        buffers.clear();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    SinkConfig     cfg;
+    unsigned short port = SERV_PORT;
+    std::string    ip = "0.0.0.0";
+    int            c;
+
+    while ((c = getopt(argc, argv, "t:cTd:b:w:")) != -1) {
+        switch (c) {
+        case 't': cfg.threads = atoi(optarg); break;
+        case 'c': cfg.pin = true; break;
+        case 'T': cfg.kernelTime = true; break;
+        case 'd': cfg.duration = atoi(optarg); break;
+        case 'b': cfg.batch = atoi(optarg); break;
+        case 'w': cfg.workers = atoi(optarg); break;
+        default:
+            err_quit("usage: udpsink [-t threads] [-c] [-T] [-d seconds] [-b batch] [-w workers] [ <IPaddress> ] [port]");
+        }
+    }
+
+    if (argc - optind == 1) {
+        port = atoi(argv[optind]);
+    } else if (argc - optind == 2) {
+        ip = argv[optind];
+        port = atoi(argv[optind + 1]);
+    } else if (argc - optind != 0) {
+        err_quit("usage: udpsink [-t threads] [-c] [-T] [-d seconds] [-b batch] [-w workers] [ <IPaddress> ] [port]");
+    }
+
+    if (cfg.threads < 1)
+        cfg.threads = 1;
+    if (cfg.batch < 1)
+        cfg.batch = 1;
+    if (cfg.batch > UDPSocket::MAX_BATCH)
+        cfg.batch = UDPSocket::MAX_BATCH;
+    if (cfg.workers > 0 && cfg.kernelTime)
+        err_quit("-T cannot be used with -w: pooled buffers do not carry kernel timestamps");
+
+    // 线程都阻塞在接收或等待中, main直接exit, 不析构这些对象
+    SocketAddress addr(ip.c_str(), port);
+    std::vector<ThreadStats> stats(cfg.workers > 0 ? cfg.workers : cfg.threads);
+    DatagramBufferPool pool(cfg.workers > 0 ? POOL_BUFFERS : 1, MAXDG);
+    std::vector<WorkQueue> queues(cfg.workers);
+    ThreadStats receiverStats;
+    if (cfg.workers > 0) {
+        for (int i = 0; i < cfg.workers; i++)
+            std::thread(pooled_worker, std::ref(queues[i]), std::ref(pool), std::ref(stats[i])).detach();
+        for (int i = 0; i < cfg.threads; i++)
+            std::thread(pooled_receiver, i, std::cref(cfg), std::cref(addr), std::ref(pool),
+                    std::ref(queues), std::ref(receiverStats)).detach();
+    } else {
+        for (int i = 0; i < cfg.threads; i++)
+            std::thread(sink, i, std::cref(cfg), std::cref(addr), std::ref(stats[i])).detach();
+    }
+
+    uint64_t lastPackets = 0, lastBytes = 0;
+    int      activeSeconds = 0;     // 收到过报文的秒数, 用于计算平均速率
+    for (int sec = 0; sec < cfg.duration; sec++) {
+        sleep(1);
+        uint64_t packets = 0, bytes = 0, lost = 0, reordered = 0;
+        for (auto &s: stats) {
+            packets += s.packets.load(std::memory_order_relaxed);
+            bytes += s.bytes.load(std::memory_order_relaxed);
+            lost += s.lost.load(std::memory_order_relaxed);
+            reordered += s.reordered.load(std::memory_order_relaxed);
+        }
+        printf("recv: %10llu pps %8.3f Gbps lost %llu reordered %llu\n",
+                (unsigned long long) (packets - lastPackets), (bytes - lastBytes) * 8 / 1e9,
+                (unsigned long long) lost, (unsigned long long) reordered);
+        fflush(stdout);
+        if (packets != lastPackets)
+            activeSeconds++;
+        lastPackets = packets;
+        lastBytes = bytes;
+    }
+
+    // 接收线程阻塞在recvmmsg中, 汇总只读取原子计数, 然后直接退出进程
+    uint64_t packets = 0, bytes = 0, lost = 0, reordered = 0, invalid = 0;
+    std::vector<uint64_t> hist(LatencyHistogram::BUCKETS);
+    for (auto &s: stats) {
+        packets += s.packets;
+        bytes += s.bytes;
+        lost += s.lost;
+        reordered += s.reordered;
+        invalid += s.invalid;
+        s.latency.accumulate(hist);
+    }
+    uint64_t valid = packets - invalid;
+    if (activeSeconds == 0)
+        activeSeconds = 1;
+    printf("total: %llu packets, %.0f pps, %.3f Gbps\n", (unsigned long long) packets,
+            (double) packets / activeSeconds, bytes * 8.0 / activeSeconds / 1e9);
+    printf("loss: %llu (%.4f%%), reordered: %llu, invalid: %llu\n",
+            (unsigned long long) lost, valid + lost ? 100.0 * lost / (valid + lost) : 0.0,
+            (unsigned long long) reordered, (unsigned long long) invalid);
+    if (cfg.workers > 0)
+        printf("pool: %d buffers, %llu packets dropped with the pool empty\n", pool.bufferCount(),
+                (unsigned long long) receiverStats.poolEmpty.load());
+    if (valid > 0) {
+        printf("latency(%s) us: p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f p99.99 %.1f\n",
+                cfg.kernelTime ? "kernel" : (cfg.workers > 0 ? "worker" : "user"),
+                percentile(hist, valid, 0.50) / 1e3, percentile(hist, valid, 0.90) / 1e3,
+                percentile(hist, valid, 0.99) / 1e3, percentile(hist, valid, 0.999) / 1e3,
+                percentile(hist, valid, 0.9999) / 1e3);
+    }
+
+    exit(0);
+}
@@ -0,0 +1,219 @@
+/**
+ * @file AddressLiteral.hpp
+ * @brief 编译期解析的IPv4/IPv6地址字面量
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_ADDRESS_LITERAL_INC
+#define MINI_SOCKET_ADDRESS_LITERAL_INC
+
+#include <cstddef>
+#include <cstdint>
+#include "CompactSocketAddress.hpp"
+
+namespace mini_socket {
+
+namespace detail {
+
+/**
+ * @brief 地址字面量格式错误
+ *
+ * 不是constexpr函数: 在常量表达式中走到这里会导致编译错误, 运行期调用则抛出SYSException
+ */
+[[ noreturn ]] void address_literal_error(const char *message);
+
+constexpr bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+constexpr int hex_digit(char c)
+{
+    return (c >= '0' && c <= '9') ? c - '0' :
+        (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+        (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+}
+
+// [pos, end)中第一个c的位置, 没有时返回end
+constexpr size_t find_char(const char *s, size_t pos, size_t end, char c)
+{
+    return pos == end ? end : s[pos] == c ? pos : find_char(s, pos + 1, end, c);
+}
+
+// [pos, end)中第一个"::"的位置, 没有时返回end
+constexpr size_t find_double_colon(const char *s, size_t pos, size_t end)
+{
+    return pos + 1 >= end ? end :
+        (s[pos] == ':' && s[pos + 1] == ':') ? pos : find_double_colon(s, pos + 1, end);
+}
+
+// 点分十进制, 规则与inet_pton(AF_INET)相同: 4段, 每段0~255, 不能有前导0
+constexpr uint32_t parse_ipv4(const char *s, size_t pos, size_t end,
+        int octets, uint32_t acc, uint32_t cur, int digits)
+{
+    return pos == end ?
+            ((octets == 3 && digits > 0) ? ((acc << 8) | cur) :
+                (address_literal_error("invalid IPv4 address literal"), 0u)) :
+        is_digit(s[pos]) ?
+            (((digits == 1 && cur == 0) || cur * 10 + (s[pos] - '0') > 255) ?
+                (address_literal_error("invalid IPv4 address literal"), 0u) :
+                parse_ipv4(s, pos + 1, end, octets, acc, cur * 10 + (s[pos] - '0'), digits + 1)) :
+        (s[pos] == '.' && digits > 0 && octets < 3) ?
+            parse_ipv4(s, pos + 1, end, octets + 1, (acc << 8) | cur, 0, 0) :
+        (address_literal_error("invalid IPv4 address literal"), 0u);
+}
+
+constexpr uint32_t parse_ipv4(const char *s, size_t pos, size_t end)
+{
+    return parse_ipv4(s, pos, end, 0, 0, 0, 0);
+}
+
+// IPv6地址中的一组: 1~4个十六进制数字
+constexpr uint32_t parse_hex_group(const char *s, size_t pos, size_t end, uint32_t acc)
+{
+    return pos == end ? acc :
+        hex_digit(s[pos]) < 0 ? (address_literal_error("invalid IPv6 address literal"), 0u) :
+        parse_hex_group(s, pos + 1, end, (acc << 4) | hex_digit(s[pos]));
+}
+
+constexpr uint32_t parse_hex_group(const char *s, size_t begin, size_t end)
+{
+    return (begin == end || end - begin > 4) ?
+        (address_literal_error("invalid IPv6 address literal"), 0u) :
+        parse_hex_group(s, begin, end, 0);
+}
+
+constexpr bool is_dotted(const char *s, size_t begin, size_t end)
+{
+    return find_char(s, begin, end, '.') != end;
+}
+
+// "::"两侧的一段(由':'分隔的若干组)包含的16位字数, 只有最后一组可以是点分十进制(2个字)
+constexpr int segment_words_from(const char *s, size_t group, size_t groupEnd, size_t end, int count)
+{
+    return groupEnd == end ?
+            (is_dotted(s, group, groupEnd) ?
+                (parse_ipv4(s, group, groupEnd), count + 2) :
+                (parse_hex_group(s, group, groupEnd), count + 1)) :
+        (parse_hex_group(s, group, groupEnd),
+            segment_words_from(s, groupEnd + 1, find_char(s, groupEnd + 1, end, ':'), end, count + 1));
+}
+
+constexpr int segment_words(const char *s, size_t begin, size_t end)
+{
+    return begin == end ? 0 : segment_words_from(s, begin, find_char(s, begin, end, ':'), end, 0);
+}
+
+// 一段中的第k个16位字
+constexpr uint32_t segment_word_from(const char *s, size_t group, size_t groupEnd, size_t end, int k)
+{
+    return is_dotted(s, group, groupEnd) ?
+            (k == 0 ? parse_ipv4(s, group, groupEnd) >> 16 : parse_ipv4(s, group, groupEnd) & 0xffff) :
+        k == 0 ? parse_hex_group(s, group, groupEnd) :
+        segment_word_from(s, groupEnd + 1, find_char(s, groupEnd + 1, end, ':'), end, k - 1);
+}
+
+constexpr uint32_t segment_word(const char *s, size_t begin, size_t end, int k)
+{
+    return segment_word_from(s, begin, find_char(s, begin, end, ':'), end, k);
+}
+
+// 整个地址的第i个16位字; colon为"::"的位置, 没有时等于end
+constexpr uint32_t ipv6_word(const char *s, size_t colon, size_t end, int head, int tail, int i)
+{
+    return colon == end ? segment_word(s, 0, end, i) :
+        i < head ? segment_word(s, 0, colon, i) :
+        i >= 8 - tail ? segment_word(s, colon + 2, end, i - (8 - tail)) : 0;
+}
+
+// 检查格式: 没有"::"时正好8个字; 有"::"时只能有一个, 且至少代表一个字,
+// 点分十进制只能出现在末尾
+constexpr bool check_ipv6(const char *s, size_t colon, size_t end, int head, int tail)
+{
+    return (colon == end ? head == 8 :
+            (head + tail <= 7 && !is_dotted(s, 0, colon) &&
+             find_double_colon(s, colon + 2, end) == end)) ?
+        true : (address_literal_error("invalid IPv6 address literal"), false);
+}
+
+constexpr AddressBytes ipv6_bytes(const char *s, size_t colon, size_t end, int head, int tail)
+{
+    return check_ipv6(s, colon, end, head, tail), AddressBytes{{
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 0) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 0),
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 1) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 1),
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 2) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 2),
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 3) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 3),
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 4) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 4),
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 5) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 5),
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 6) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 6),
+        (uint8_t) (ipv6_word(s, colon, end, head, tail, 7) >> 8), (uint8_t) ipv6_word(s, colon, end, head, tail, 7),
+    }};
+}
+
+constexpr AddressBytes ipv6_bytes(const char *s, size_t colon, size_t end)
+{
+    return colon == end ?
+        ipv6_bytes(s, colon, end, segment_words(s, 0, end), 0) :
+        ipv6_bytes(s, colon, end, segment_words(s, 0, colon), segment_words(s, colon + 2, end));
+}
+
+constexpr AddressBytes ipv4_bytes(uint32_t v)
+{
+    return AddressBytes{{ (uint8_t) (v >> 24), (uint8_t) (v >> 16), (uint8_t) (v >> 8), (uint8_t) v }};
+}
+
+}   // namespace detail
+
+/**
+ * @brief 从字符串字面量构造IPv4地址, 可以在编译期求值
+ *
+ * @code
+ * constexpr CompactSocketAddress HEALTH_ENDPOINT = make_ipv4_address("127.0.0.1", 8081);
+ * TCPServerSocket server(HEALTH_ENDPOINT.toSocketAddress());
+ * @endcode
+ *
+ * @param literal 点分十进制的地址
+ * @param port 端口号
+ *
+ * @return 地址
+ *
+ * @note 用于初始化constexpr变量时, 格式错误会导致编译失败; 在运行期求值时抛出SYSException
+ */
+template <size_t N>
+constexpr CompactSocketAddress make_ipv4_address(const char (&literal)[N], uint16_t port)
+{
+    return CompactSocketAddress(AF_INET, detail::ipv4_bytes(detail::parse_ipv4(literal, 0, N - 1)), port);
+}
+
+/**
+ * @brief 从字符串字面量构造IPv6地址, 可以在编译期求值
+ *
+ * @param literal IPv6地址, 支持"::"压缩和末尾的点分十进制, 不支持"%scope"后缀
+ * @param port 端口号
+ * @param scopeId scope id(网络接口序号), 用于链路本地地址
+ *
+ * @return 地址
+ *
+ * @note 用于初始化constexpr变量时, 格式错误会导致编译失败; 在运行期求值时抛出SYSException
+ */
+template <size_t N>
+constexpr CompactSocketAddress make_ipv6_address(const char (&literal)[N], uint16_t port, uint32_t scopeId = 0)
+{
+    return CompactSocketAddress(AF_INET6,
+            detail::ipv6_bytes(literal, detail::find_double_colon(literal, 0, N - 1), N - 1), port, scopeId);
+}
+
+/**
+ * @brief 从字符串字面量构造地址, 包含':'的按IPv6解析, 否则按IPv4解析
+ */
+template <size_t N>
+constexpr CompactSocketAddress make_address(const char (&literal)[N], uint16_t port)
+{
+    return detail::find_char(literal, 0, N - 1, ':') != N - 1 ?
+        make_ipv6_address(literal, port) : make_ipv4_address(literal, port);
+}
+
+}   // mini_socket
+
+#endif
@@ -9,6 +9,7 @@
 #define MINI_SOCKET_COMMUNICATING_SOCKET_INC
 
 #include "Socket.hpp"
+#include "SocketTimestamp.hpp"
 
 namespace mini_socket {
 
@@ -50,9 +51,20 @@ public:
      *
      * @return 返回发送出的数据长度
      *
-     * @note 可能会抛出SocketException异常, 发送长度也可能会小于bufferLen
+     * @note 可能会抛出SocketException异常, 发送长度也可能会小于bufferLen;
+     *       子类(如ShmChannel)可以替换数据的传输方式, sendAll也随之改变
      */
-    int send(const char *buffer, int bufferLen); 
+    virtual int send(const char *buffer, int bufferLen); 
+
+    /**
+     * @brief 发送所有数据
+     *
+     * @param buffer 要发送数据的内容
+     * @param bufferLen 数据长度
+     *
+     * @note 可能会抛出SocketException异常
+     */
+    void sendAll(const char *buffer, int bufferLen); 
 
     /**
      * @brief 接收数据
@@ -64,7 +76,22 @@ public:
      *
      * @note 可能会抛出SocketException异常
      */
-    int recv(char *buffer, int bufferLen); 
+    virtual int recv(char *buffer, int bufferLen); 
+
+#if defined (__linux__)
+    /**
+     * @brief 接收数据, 同时返回内核接收时间戳
+     *
+     * @param buffer 接收数据缓存地址
+     * @param bufferLen 缓存长度
+     * @param[out] ts 内核接收时间戳, 需要先调用enableTimestamping
+     *
+     * @return 接收数据长度
+     *
+     * @note 可能会抛出SocketException异常, 对于TCP, 时间戳对应本次读到的最后一个报文
+     */
+    int recv(char *buffer, int bufferLen, SocketTimestamp &ts); 
+#endif
 
     /**
      * @brief 获取已连接成功的对端地址
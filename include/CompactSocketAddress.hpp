@@ -0,0 +1,218 @@
+/**
+ * @file CompactSocketAddress.hpp
+ * @brief 紧凑的, 可比较可哈希的Socket地址
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_COMPACT_SOCKET_ADDRESS_INC
+#define MINI_SOCKET_COMPACT_SOCKET_ADDRESS_INC
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include "SocketCommon.hpp"
+
+namespace mini_socket {
+
+class SocketAddress;
+class SocketAddressView;
+
+/**
+ * @brief 16字节的地址(网络字节序), IPv4地址只用前4个字节
+ */
+struct AddressBytes {
+    uint8_t bytes[16];
+};
+
+namespace detail {
+
+// 编译期的htons
+constexpr uint16_t host_to_network16(uint16_t v)
+{
+#if defined (__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    return v;
+#else
+    return (uint16_t) ((v >> 8) | (v << 8));
+#endif
+}
+
+}   // namespace detail
+
+/**
+ * @brief 紧凑的IPv4/IPv6 Socket地址, 只有24字节
+ *
+ * 只保存地址族, 地址, 端口和IPv6的scope id, 适合作为大规模哈希表(如按UDP源地址
+ * 索引的会话表)的键. 与SocketAddress之间可以无损转换(IPv6的flowinfo不保存).
+ *
+ * 相等比较和哈希直接作用于这24个字节; 排序按地址族, 地址(数值序), 端口,
+ * scope id进行.
+ */
+class CompactSocketAddress {
+public:
+    /**
+     * @brief 构造一个空地址, 地址族为AF_UNSPEC
+     */
+    CompactSocketAddress() = default;
+
+    /**
+     * @brief 从地址族, 地址, 端口和scope id构造, 可以在编译期求值
+     *
+     * @param family AF_INET或AF_INET6
+     * @param addr 地址
+     * @param port 端口号(主机字节序)
+     * @param scopeId IPv6的scope id
+     *
+     * @note 通常通过AddressLiteral.hpp中的make_ipv4_address/make_ipv6_address构造
+     */
+    constexpr CompactSocketAddress(int family, const AddressBytes &addr, uint16_t port, uint32_t scopeId = 0):
+        family_((uint16_t) family),
+        addr_{ addr.bytes[0], addr.bytes[1], addr.bytes[2], addr.bytes[3],
+               addr.bytes[4], addr.bytes[5], addr.bytes[6], addr.bytes[7],
+               addr.bytes[8], addr.bytes[9], addr.bytes[10], addr.bytes[11],
+               addr.bytes[12], addr.bytes[13], addr.bytes[14], addr.bytes[15] },
+        port_(detail::host_to_network16(port)),
+        scopeId_(scopeId)
+    {
+    }
+
+    /**
+     * @brief 从sockaddr构造
+     *
+     * @param sa sockaddr地址的指针
+     * @param salen sockaddr地址的长度
+     *
+     * @note 不是IPv4/IPv6地址时得到空地址
+     */
+    CompactSocketAddress(const sockaddr *sa, socklen_t salen);
+
+    /**
+     * @brief 从SocketAddress构造
+     */
+    explicit CompactSocketAddress(const SocketAddress &addr);
+
+    /**
+     * @brief 从SocketAddressView构造
+     */
+    explicit CompactSocketAddress(const SocketAddressView &addr);
+
+    /**
+     * @brief 从sockaddr重新设置地址
+     *
+     * @param sa sockaddr地址的指针
+     * @param salen sockaddr地址的长度
+     *
+     * @return 如果是IPv4/IPv6地址, 返回true; 否则设置成空地址, 返回false
+     */
+    bool assign(const sockaddr *sa, socklen_t salen);
+
+    /**
+     * @brief 转换成sockaddr
+     *
+     * @param ss 输出的sockaddr_storage
+     *
+     * @return sockaddr的实际长度, 空地址返回0
+     */
+    socklen_t toSockaddr(sockaddr_storage *ss) const;
+
+    /**
+     * @brief 转换成SocketAddress
+     */
+    SocketAddress toSocketAddress() const;
+
+    /**
+     * @brief 是否为空地址
+     */
+    constexpr bool empty() const { return family_ == AF_UNSPEC; }
+
+    /**
+     * @brief 获取sockaddr类型(网络层协议)
+     */
+    NetworkLayerType getNetworkLayerType() const;
+
+    /**
+     * @brief 获取端口号(主机字节序)
+     */
+    uint16_t getPort() const { return ntohs(port_); }
+
+    /**
+     * @brief 获取IPv6的scope id, IPv4地址为0
+     */
+    constexpr uint32_t getScopeId() const { return scopeId_; }
+
+    /**
+     * @brief 格式化到调用者提供的缓冲区中, 格式与SocketAddress::format相同
+     *
+     * @return 写入的字符数(不含'\0'); 空地址或缓冲区不足时返回0
+     */
+    size_t format(char *buf, size_t len) const;
+
+    /**
+     * @brief 转换成可打印格式
+     *
+     * @return ipv4: xxx.xxx.xxx.xxx:port, ipv6: [xxx:xxx:...:xxx]:port
+     */
+    std::string toString() const;
+
+    /**
+     * @brief 哈希值
+     */
+    size_t hash() const
+    {
+        uint64_t w[3];
+        memcpy(w, this, sizeof(w));
+        uint64_t h = (w[0] ^ (w[1] * 0x9e3779b97f4a7c15ULL)) * 0xff51afd7ed558ccdULL;
+        h = (h ^ (h >> 32) ^ w[2]) * 0xc4ceb9fe1a85ec53ULL;
+        return (size_t) (h ^ (h >> 29));
+    }
+
+    friend bool operator ==(const CompactSocketAddress &a, const CompactSocketAddress &b)
+    {
+        return memcmp(&a, &b, sizeof(CompactSocketAddress)) == 0;
+    }
+
+    friend bool operator !=(const CompactSocketAddress &a, const CompactSocketAddress &b)
+    {
+        return !(a == b);
+    }
+
+    friend bool operator <(const CompactSocketAddress &a, const CompactSocketAddress &b)
+    {
+        // scope id是主机字节序, 不能参与memcmp, 单独按数值比较
+        int c = memcmp(&a, &b, sizeof(CompactSocketAddress) - sizeof(a.scopeId_));
+        if (c != 0)
+            return c < 0;
+        return a.scopeId_ < b.scopeId_;
+    }
+
+private:
+    // 成员的顺序决定了memcmp的排序: 地址族(小于256, 低字节在前也能正确比较),
+    // 地址和端口(网络字节序); 最后的scope id单独比较; 中间没有填充字节
+    uint16_t family_ = AF_UNSPEC;
+    uint8_t  addr_[16] = {};        // IPv4地址只用前4个字节, 其余为0
+    uint16_t port_ = 0;             // 网络字节序
+    uint32_t scopeId_ = 0;
+};
+
+/**
+ * @brief 以toString()的格式输出CompactSocketAddress
+ */
+std::ostream &operator <<(std::ostream &os, const CompactSocketAddress &addr);
+
+}   // mini_socket
+
+namespace std {
+
+template <>
+struct hash<mini_socket::CompactSocketAddress> {
+    size_t operator ()(const mini_socket::CompactSocketAddress &addr) const
+    {
+        return addr.hash();
+    }
+};
+
+}   // namespace std
+
+#endif
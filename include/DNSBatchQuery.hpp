@@ -0,0 +1,146 @@
+/**
+ * @file DNSBatchQuery.hpp
+ * @brief 批量异步DNS解析(getaddrinfo_a)
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_DNS_BATCH_QUERY_INC
+#define MINI_SOCKET_DNS_BATCH_QUERY_INC
+
+#include "DNSResolver.hpp"
+
+#if defined (__linux__)
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mini_socket {
+
+/**
+ * @brief 批量异步DNS解析: submit一次提交所有主机名(每个主机名一个getaddrinfo_a请求), 在截止时间前等待结果
+ *
+ * 典型用法:
+ * @code
+ * DNSBatchQuery batch(TransportLayerType::TCP);
+ * batch.add("www.example.com", "80");
+ * batch.add("www.example.org", "443");
+ * batch.submit();
+ * batch.wait(2000);    // 2秒后还没完成的请求被取消
+ * for (size_t i = 0; i < batch.size(); i++) {
+ *     SocketError ec = batch.getError(i);
+ *     ...
+ * }
+ * @endcode
+ *
+ * @note 解析在glibc内部的线程池中进行, 调用线程只在wait中阻塞;
+ *       也可以传入eventfd, 全部完成时被通知, 由epoll等事件循环处理.
+ *       每个主机名单独调用一次getaddrinfo_a, 完成时各自在glibc的新线程中通知:
+ *       一次提交一组请求时glibc只在全部完成后通知一次, 其中有请求被取消就不再通知;
+ *       不使用gai_suspend, glibc 2.36的gai_suspend在查询并发完成时会访问已释放的内存
+ */
+class DNSBatchQuery {
+public:
+    /**
+     * @brief 创建一个批量查询
+     *
+     * @param trans_type 传输层协议类型: TCP or UDP
+     */
+    DNSBatchQuery(TransportLayerType trans_type);
+
+    /**
+     * @brief 析构批量查询, 取消所有未完成的请求, 只等待已经在解析中, 取消不了的请求
+     */
+    ~DNSBatchQuery();
+
+    /**
+     * @brief 添加一个查询, 必须在submit之前调用
+     *
+     * @param host 被解析的主机名
+     * @param serv 被解析的服务名
+     *
+     * @return 查询的序号
+     */
+    size_t add(const char *host, const char *serv);
+
+    /**
+     * @brief 一次性提交所有查询, 不阻塞
+     *
+     * 提交失败的查询立即完成, getError返回getaddrinfo_a的错误码
+     *
+     * @param eventFd 如果不小于0, 所有查询完成(或被取消)后向该eventfd写入1
+     */
+    void submit(int eventFd = -1);
+
+    /**
+     * @brief 等待所有查询完成, 到截止时间还未完成的查询被取消
+     *
+     * @param timeoutMs 最多等待的毫秒数, -1表示一直等待
+     *
+     * @return 全部完成返回true; 有查询因超时被取消返回false
+     */
+    bool wait(int timeoutMs);
+
+    /**
+     * @brief 取消所有未完成的查询
+     *
+     * 还在排队的查询被取消, 之后isDone返回true, getError返回EAI_CANCELED;
+     * 已经在解析中的查询取消不了, 仍会正常完成
+     */
+    void cancel();
+
+    /**
+     * @brief 获取查询个数
+     */
+    size_t size() const { return requests_.size(); }
+
+    /**
+     * @brief 判断查询是否已完成(成功, 失败或被取消)
+     *
+     * @param index 查询的序号
+     */
+    bool isDone(size_t index) const;
+
+    /**
+     * @brief 获取查询的错误码
+     *
+     * @param index 查询的序号
+     *
+     * @return 成功返回no_error; 未完成时返回EAI_INPROGRESS, 被取消返回EAI_CANCELED
+     */
+    SocketError getError(size_t index) const;
+
+    /**
+     * @brief 获取查询结果
+     *
+     * @param index 查询的序号
+     *
+     * @return 解析结果
+     *
+     * @note 查询未成功完成时抛出GAIException异常
+     */
+    DNSResolver::ResultRange getResult(size_t index);
+
+private:
+    struct Request;
+
+    DNSBatchQuery(const DNSBatchQuery &) = delete;
+    void operator=(const DNSBatchQuery &) = delete;
+
+    void complete(Request &req, int error);
+
+    addrinfo hints_;
+    std::vector<std::unique_ptr<Request>> requests_;
+    int eventFd_ = -1;
+    bool submitted_ = false;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    size_t finished_ = 0;       // 已完成(包括被取消)的查询个数, 由mutex_保护
+};
+
+}   // mini_socket
+#endif
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file DNSCache.hpp
+ * @brief 进程内共享的DNS解析结果缓存
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_DNS_CACHE_INC
+#define MINI_SOCKET_DNS_CACHE_INC
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "DNSResolver.hpp"
+
+namespace mini_socket {
+
+/**
+ * @brief 进程内共享的DNS解析结果缓存, 按(host, service, family, socktype)分片存储
+ *
+ * 每个分片有自己的锁和LRU链表, 不同主机名的查询基本不会互相竞争.
+ * getaddrinfo不返回TTL, 所以缓存条目统一使用配置的有效期.
+ * 过期后的条目在最大陈旧时间内仍然可以返回, 同时交给一个常驻的后台线程刷新;
+ * 主机名不存在(EAI_NONAME)的结果可以按较短的有效期缓存.
+ *
+ * @note 默认关闭, 通过DNSResolver::enableCache开启
+ */
+class DNSCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * @brief 查找结果
+     */
+    enum LookupStatus {
+        MISS = 0,       /**< 没有可用的条目 */
+        FRESH = 1,      /**< 未过期的解析结果 */
+        STALE = 2,      /**< 已过期, 但仍在最大陈旧时间内的解析结果 */
+        NEGATIVE = 3,   /**< 缓存的解析失败 */
+    };
+
+    /**
+     * @brief 缓存的键
+     */
+    struct Key {
+        std::string host;
+        std::string serv;
+        int family = 0;
+        int socktype = 0;
+
+        Key() = default;
+        Key(const char *host, const char *serv, int family, int socktype);
+
+        bool operator ==(const Key &rhs) const
+        {
+            return family == rhs.family && socktype == rhs.socktype &&
+                host == rhs.host && serv == rhs.serv;
+        }
+    };
+
+    /**
+     * @brief 键的哈希函数
+     */
+    struct KeyHash {
+        size_t operator ()(const Key &key) const;
+    };
+
+    /**
+     * @brief 获取进程内唯一的缓存
+     */
+    static DNSCache &instance();
+
+    /**
+     * @brief 缓存是否开启
+     */
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 开启或关闭缓存, 关闭时同时清空
+     *
+     * @param on 是否开启
+     */
+    void setEnabled(bool on);
+
+    /**
+     * @brief 设置缓存条目的有效期
+     *
+     * @param ttlMs 有效期, 毫秒
+     */
+    void setTTL(int ttlMs);
+
+    /**
+     * @brief 设置条目过期后还可以返回的最长时间(stale-while-revalidate)
+     *
+     * @param maxStaleMs 最大陈旧时间, 毫秒; 0表示过期即失效
+     */
+    void setMaxStale(int maxStaleMs);
+
+    /**
+     * @brief 设置解析失败结果的有效期
+     *
+     * @param ttlMs 有效期, 毫秒; 0表示不缓存解析失败
+     */
+    void setNegativeTTL(int ttlMs);
+
+    /**
+     * @brief 是否缓存解析失败
+     */
+    bool isNegativeEnabled() const { return negativeTtlMs_.load(std::memory_order_relaxed) > 0; }
+
+    /**
+     * @brief 设置最多缓存的条目数, 超过后淘汰最久未使用的条目
+     *
+     * @param maxEntries 最大条目数
+     *
+     * @note 上限按分片均分, 各分片独立淘汰
+     */
+    void setMaxEntries(size_t maxEntries);
+
+    /**
+     * @brief 查找解析结果
+     *
+     * @param key 查询的键
+     * @param[out] result FRESH或STALE时返回解析结果
+     * @param[out] error NEGATIVE时返回缓存的错误码(EAI_*)
+     * @param[out] needRefresh STALE时, 只有第一个拿到陈旧结果的调用者得到true, 由它负责刷新
+     *
+     * @return 查找结果
+     */
+    LookupStatus lookup(const Key &key, DNSResolver::ResultRange &result, int &error, bool &needRefresh);
+
+    /**
+     * @brief 插入或更新解析结果
+     *
+     * @param key 查询的键
+     * @param result 解析结果
+     */
+    void insert(const Key &key, const DNSResolver::ResultRange &result);
+
+    /**
+     * @brief 缓存一次解析失败
+     *
+     * @param key 查询的键
+     * @param error 错误码(EAI_*)
+     *
+     * @return 是否缓存了这个结果; 没有启用失败缓存(negative TTL为0)时返回false,
+     *         此时已有的条目不变, 后台刷新的调用者需要调用refreshFailed
+     */
+    bool insertNegative(const Key &key, int error);
+
+    /**
+     * @brief 后台刷新失败, 允许之后的调用者再次发起刷新
+     *
+     * @param key 查询的键
+     */
+    void refreshFailed(const Key &key);
+
+    /**
+     * @brief 清空缓存
+     */
+    void clear();
+
+    /**
+     * @brief 获取当前缓存的条目数
+     */
+    size_t size() const;
+
+private:
+    struct Entry {
+        DNSResolver::ResultRange result;
+        int error = 0;                  // 不为0时是缓存的解析失败
+        bool refreshing = false;        // 已经有调用者在刷新
+        Clock::time_point expires;
+        Clock::time_point staleUntil;   // 超过后条目被删除
+        std::list<Key>::iterator lru;   // 在LRU链表中的位置
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        std::list<Key> lru;             // 表头是最近使用的条目
+    };
+
+    static const int SHARD_COUNT = 16;
+
+    DNSCache() = default;
+    DNSCache(const DNSCache &) = delete;
+    void operator=(const DNSCache &) = delete;
+
+    Shard &shardOf(const Key &key);
+    Entry &put(const Key &key, int ttlMs, int maxStaleMs);
+
+    Shard shards_[SHARD_COUNT];
+    std::atomic<bool> enabled_{false};
+    std::atomic<int> ttlMs_{30000};
+    std::atomic<int> maxStaleMs_{0};
+    std::atomic<int> negativeTtlMs_{0};
+    std::atomic<size_t> maxEntriesPerShard_{4096 / SHARD_COUNT};
+};
+
+}   // mini_socket
+
+#endif
@@ -8,8 +8,12 @@
 #ifndef MINI_SOCKET_DNS_RESOLVER_INC
 #define MINI_SOCKET_DNS_RESOLVER_INC
 
-#include <memory>
+#include <functional>
+#include <future>
+#include <vector>
 #include "SocketCommon.hpp"
+#include "SocketError.hpp"
+#include "SocketAddress.hpp"
 #include "SocketAddressView.hpp"
 
 namespace mini_socket {
@@ -19,46 +23,51 @@ namespace mini_socket {
  */
 class DNSResolver {
 public:
+    /**
+     * @brief DNS解析结果中的一个地址
+     */
+    struct ResultEntry {
+        union {
+            sockaddr sa;
+            sockaddr_in sin;
+            sockaddr_in6 sin6;
+        } addr;
+        socklen_t addrLen;
+    };
+
     /**
      * @brief DNS解析结果迭代器
      */
     struct ResultIterator {
-        addrinfo *res = 0;
+        const ResultEntry *entry = nullptr;
 
-        ResultIterator(): res(nullptr)
-        {
-        }
+        ResultIterator() = default;
 
-        ResultIterator(addrinfo *res): res(res)
+        ResultIterator(const ResultEntry *entry): entry(entry)
         {
         }
 
-        void next()
-        {
-            res = res->ai_next;
-        }
-
         SocketAddressView operator *() const
         {
-            return SocketAddressView(res->ai_addr, res->ai_addrlen);
+            return SocketAddressView(&entry->addr.sa, entry->addrLen);
         }
 
         ResultIterator &operator ++()
         {
-            next();
+            ++entry;
             return *this;
         }
 
         ResultIterator operator ++(int)
         {
             ResultIterator tmp(*this);
-            next();
+            ++entry;
             return tmp;
         }
 
         bool operator ==(const ResultIterator &rhs) const
         {
-            return this->res == rhs.res;
+            return this->entry == rhs.entry;
         }
 
         bool operator !=(const ResultIterator &rhs) const
@@ -68,15 +77,56 @@ public:
     };
 
     /**
-     * @brief DNS解析结果集
+     * @brief DNS解析结果集, 地址按值保存在连续数组中
+     *
+     * 不超过INLINE_CAPACITY个地址时不分配内存, 复制就是一次memcpy,
+     * 可以直接缓存或传给其他线程; 迭代得到的SocketAddressView指向结果集内部,
+     * 只在结果集存活期间有效.
      */
-    struct ResultRange {
-        std::shared_ptr<addrinfo> ressave;
-
-        ResultRange(std::shared_ptr<addrinfo> ressave): ressave(ressave) {}
-
-        ResultIterator begin() const { return ResultIterator(ressave.get()); }
-        ResultIterator end() const { return ResultIterator(nullptr); }
+    class ResultRange {
+    public:
+        static const int INLINE_CAPACITY = 4;   // 内联保存的地址个数
+
+        ResultRange() = default;
+
+        /**
+         * @brief 从getaddrinfo的结果复制地址, 调用者仍然负责freeaddrinfo
+         *
+         * @param res addrinfo链表
+         */
+        explicit ResultRange(const addrinfo *res);
+
+        ResultRange(const ResultRange &rhs);
+        ResultRange(ResultRange &&rhs);
+        ResultRange &operator =(const ResultRange &rhs);
+        ResultRange &operator =(ResultRange &&rhs);
+        ~ResultRange();
+
+        /**
+         * @brief 追加一个地址
+         *
+         * @param sa sockaddr地址的指针
+         * @param salen sockaddr地址的长度
+         */
+        void push_back(const sockaddr *sa, socklen_t salen);
+
+        /**
+         * @brief 转换成SocketAddress数组, 结果与结果集的生命期无关
+         */
+        std::vector<SocketAddress> toVector() const;
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        SocketAddressView operator [](size_t i) const { return *ResultIterator(data_ + i); }
+
+        ResultIterator begin() const { return ResultIterator(data_); }
+        ResultIterator end() const { return ResultIterator(data_ + size_); }
+
+    private:
+        ResultEntry inline_[INLINE_CAPACITY];
+        ResultEntry *data_ = inline_;
+        uint32_t size_ = 0;
+        uint32_t capacity_ = INLINE_CAPACITY;
     };
 
     /**
@@ -87,6 +137,10 @@ public:
      * @param trans_type 传输层协议类型: TCP or UDP
      *
      * @return 解析结果迭代器
+     *
+     * @note 数字形式的地址和端口(如"10.0.0.1", "8080")直接构造结果, 不调用getaddrinfo;
+     *       多个线程同时发起相同的查询时只执行一次getaddrinfo,
+     *       其他线程等待并共享同一份结果或错误
      */
     ResultRange query(const char *host, const char *serv, TransportLayerType trans_type); 
 
@@ -102,8 +156,61 @@ public:
      */
     ResultRange query(const char *host, const char *serv, NetworkLayerType net_type, TransportLayerType trans_type); 
 
+#if defined (__linux__)
+    /**
+     * @brief 异步DNS解析完成时的回调, 成功时ec.type为SocketError::no_error
+     */
+    typedef std::function<void (ResultRange result, SocketError ec)> Callback;
+
+    /**
+     * @brief 异步DNS解析请求(getaddrinfo_a), 不阻塞调用线程
+     *
+     * @param host 被解析的主机名
+     * @param serv 被解析的服务名
+     * @param trans_type 传输层协议类型: TCP or UDP
+     *
+     * @return 解析结果的future, 解析失败时get()抛出GAIException异常
+     */
+    std::future<ResultRange> queryAsync(const char *host, const char *serv, TransportLayerType trans_type);
+
+    /**
+     * @brief 异步DNS解析请求(getaddrinfo_a), 完成后调用callback
+     *
+     * 需要解析时callback在getaddrinfo_a的通知线程中调用; host是数字地址或者缓存命中时
+     * 不发出请求, callback在返回之前就在调用者的线程中同步调用.
+     *
+     * @param host 被解析的主机名
+     * @param serv 被解析的服务名
+     * @param trans_type 传输层协议类型: TCP or UDP
+     * @param callback 完成回调, 不能抛出异常
+     *
+     * @note 不要在callback中再调用queryAsync: 同步调用时会不断递归直到栈溢出;
+     *       callback中也不能持有调用queryAsync时已持有的锁
+     */
+    void queryAsync(const char *host, const char *serv, TransportLayerType trans_type, Callback callback);
+#endif
+
+    /**
+     * @brief 开启进程内共享的DNS解析结果缓存, 对所有DNSResolver(包括tcp_connect/udp_connect)生效
+     *
+     * @param ttlMs 缓存条目的有效期, 毫秒
+     * @param maxEntries 最多缓存的条目数
+     * @param maxStaleMs 条目过期后仍可返回的最长时间, 毫秒; 期间第一个命中的调用者把它交给后台线程刷新,
+     *        解析服务暂时不可用时继续使用旧结果. 0表示过期即重新解析
+     * @param negativeTtlMs 主机名不存在(EAI_NONAME)的结果的缓存时间, 毫秒; 0表示不缓存
+     *
+     * @note 缓存命中时不调用getaddrinfo, 直接返回缓存的解析结果或错误
+     */
+    static void enableCache(int ttlMs = 30000, size_t maxEntries = 4096,
+            int maxStaleMs = 0, int negativeTtlMs = 0);
+
+    /**
+     * @brief 关闭并清空DNS解析结果缓存
+     */
+    static void disableCache();
+
 private:
-    std::shared_ptr<addrinfo> query(const char *host, const char *serv, addrinfo *hints); 
+    ResultRange query(const char *host, const char *serv, addrinfo *hints); 
 };
 
 }   // mini_socket
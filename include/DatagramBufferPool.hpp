@@ -0,0 +1,164 @@
+/**
+ * @file DatagramBufferPool.hpp
+ * @brief 报文缓存池: 固定大小, 按cache line对齐, 全局空闲链表无锁, 每线程带本地缓存
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_DATAGRAM_BUFFER_POOL_INC
+#define MINI_SOCKET_DATAGRAM_BUFFER_POOL_INC
+
+#include <atomic>
+#include <cstdint>
+#include "SocketAddress.hpp"
+
+namespace mini_socket {
+
+class DatagramBufferPool;
+
+/**
+ * @brief 报文缓存池中的一个缓存, 除数据外还记录报文长度和发送端地址
+ *
+ * @note 只能通过DatagramBufferPool获取和归还, 不能自行创建
+ */
+class DatagramBuffer {
+public:
+    /**
+     * @brief 获取数据区地址
+     */
+    char *data() const { return data_; }
+
+    /**
+     * @brief 获取数据区容量
+     */
+    int capacity() const { return capacity_; }
+
+    int length = 0;         // 有效数据长度
+    SocketAddress source;   // 发送端地址
+
+private:
+    friend class DatagramBufferPool;
+    DatagramBuffer(char *data, int capacity, uint32_t index);
+    DatagramBuffer(const DatagramBuffer &) = delete;
+    void operator=(const DatagramBuffer &) = delete;
+
+    char *data_;
+    int capacity_;
+    uint32_t index_;                // 在池中的下标
+    std::atomic<uint32_t> next_;    // 空闲链表中下一个缓存的下标+1, 0表示链表结束
+};
+
+/**
+ * @brief 报文缓存池, 所有缓存在构造时一次分配
+ *
+ * 接收线程把报文直接收进池中的缓存, 交给其它线程处理后由处理线程归还,
+ * 整个过程没有malloc/free. 全局空闲链表是带版本号的无锁栈,
+ * 高频使用的线程应通过LocalCache批量存取, 以减少对全局链表的竞争.
+ */
+class DatagramBufferPool {
+public:
+    /**
+     * @brief 创建缓存池
+     *
+     * @param bufferCount 缓存个数
+     * @param bufferSize 每个缓存的数据区大小, 向上取整到cache line大小
+     */
+    DatagramBufferPool(int bufferCount, int bufferSize = 2048);
+
+    /**
+     * @brief 销毁缓存池
+     *
+     * @note 销毁时所有缓存必须已经归还, 所有LocalCache必须已经销毁
+     */
+    ~DatagramBufferPool();
+
+    /**
+     * @brief 从全局空闲链表获取一个缓存
+     *
+     * @return 缓存指针; 如果池已耗尽返回NULL
+     */
+    DatagramBuffer *acquire();
+
+    /**
+     * @brief 归还一个缓存到全局空闲链表, 可以在任意线程调用
+     *
+     * @param buffer 从本池获取的缓存
+     */
+    void release(DatagramBuffer *buffer);
+
+    /**
+     * @brief 获取缓存个数
+     */
+    int bufferCount() const { return bufferCount_; }
+
+    /**
+     * @brief 获取每个缓存的数据区大小
+     */
+    int bufferSize() const { return bufferSize_; }
+
+    /**
+     * @brief 每个线程私有的缓存, 批量从全局空闲链表存取
+     *
+     * @note 不是线程安全的, 每个线程创建自己的LocalCache; 析构时把剩余缓存还给池
+     */
+    class LocalCache {
+    public:
+        /**
+         * @brief 创建本地缓存
+         *
+         * @param pool 所属的缓存池
+         * @param capacity 本地最多保留的缓存个数, 不超过MAX_CAPACITY
+         */
+        LocalCache(DatagramBufferPool &pool, int capacity = 32);
+        ~LocalCache();
+
+        /**
+         * @brief 获取一个缓存, 本地为空时从全局链表补充一半容量
+         *
+         * @return 缓存指针; 如果池已耗尽返回NULL
+         */
+        DatagramBuffer *acquire();
+
+        /**
+         * @brief 归还一个缓存, 本地满时把一半缓存一次性还给全局链表
+         *
+         * @param buffer 从同一个池获取的缓存(可以来自其它线程)
+         */
+        void release(DatagramBuffer *buffer);
+
+        static const int MAX_CAPACITY = 256;
+
+    private:
+        LocalCache(const LocalCache &) = delete;
+        void operator=(const LocalCache &) = delete;
+        void flush(int count);
+
+        DatagramBufferPool &pool_;
+        int capacity_;
+        int count_ = 0;
+        DatagramBuffer *buffers_[MAX_CAPACITY];
+    };
+
+private:
+    DatagramBufferPool(const DatagramBufferPool &) = delete;
+    void operator=(const DatagramBufferPool &) = delete;
+
+    DatagramBuffer *buffer(uint32_t index) const;
+    void pushChain(DatagramBuffer *first, DatagramBuffer *last);
+
+    static const int CACHE_LINE_SIZE = 64;
+
+    int bufferCount_;
+    int bufferSize_;
+    int headerSize_;                // 每个DatagramBuffer占用的字节数(对齐后)
+    char *memory_;                  // 原始分配的内存
+    char *headers_;                 // 对齐后的DatagramBuffer数组
+    char *data_;                    // 对齐后的数据区
+    char padBefore_[CACHE_LINE_SIZE];       // 让head_独占一个cache line
+    std::atomic<uint64_t> head_;            // 高32位版本号, 低32位栈顶下标+1
+    char padAfter_[CACHE_LINE_SIZE];
+};
+
+}   // mini_socket
+
+#endif
@@ -0,0 +1,257 @@
+/**
+ * @file InterfaceTable.hpp
+ * @brief 本机网络接口和地址表, 由netlink事件增量更新, 读取时无锁
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-19
+ */
+#ifndef MINI_SOCKET_INTERFACE_TABLE_INC
+#define MINI_SOCKET_INTERFACE_TABLE_INC
+
+#if defined (__linux__)
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <net/if.h>
+#include "CompactSocketAddress.hpp"
+#include "NetlinkSocket.hpp"
+
+namespace mini_socket {
+
+/**
+ * @brief 网络接口上的一个地址
+ */
+struct InterfaceAddress {
+    int family = AF_UNSPEC;     // AF_INET或AF_INET6
+    AddressBytes address = {};  // 网络字节序, IPv4只用前4个字节
+    int prefixLen = 0;
+    int scope = 0;              // RT_SCOPE_UNIVERSE, RT_SCOPE_HOST, RT_SCOPE_LINK等
+    unsigned flags = 0;         // IFA_F_*
+    int index = 0;              // 所在网络接口的序号
+
+    /**
+     * @brief 转换成端口为0的地址, IPv6链路本地地址带上scope id
+     */
+    CompactSocketAddress toCompactAddress() const;
+
+    /**
+     * @brief 地址所在的前缀(网段)是否包含addr
+     *
+     * @param family addr的地址族
+     * @param addr 网络字节序的地址
+     */
+    bool contains(int family, const uint8_t *addr) const;
+
+    /**
+     * @brief 是否可以用作源地址: 不是tentative, deprecated或dadfailed状态
+     */
+    bool isUsable() const;
+};
+
+/**
+ * @brief 一个网络接口
+ */
+struct InterfaceInfo {
+    int index = 0;              // 网络接口序号
+    std::string name;
+    unsigned flags = 0;         // IFF_UP, IFF_RUNNING, IFF_LOOPBACK等
+    uint32_t mtu = 0;
+    uint8_t operState = 0;      // IF_OPER_UP等
+    unsigned short linkType = 0;    // ARPHRD_ETHER等
+    std::vector<uint8_t> hwAddress;
+    std::vector<InterfaceAddress> addresses;
+
+    bool isUp() const { return (flags & IFF_UP) != 0; }
+    bool isLoopback() const { return (flags & IFF_LOOPBACK) != 0; }
+};
+
+/**
+ * @brief 某一时刻的接口表, 创建后不再修改, 可以被多个线程同时读取
+ */
+class InterfaceSnapshot {
+public:
+    InterfaceSnapshot() = default;
+
+    /**
+     * @brief 快照的代号, 每次变化后递增, 进程内所有InterfaceTable的代号都不重复
+     */
+    uint64_t generation() const { return generation_; }
+
+    /**
+     * @brief 所有接口, 按接口序号排序
+     */
+    const std::vector<InterfaceInfo> &interfaces() const { return interfaces_; }
+
+    /**
+     * @brief 按接口序号查找
+     *
+     * @return 找不到返回NULL
+     */
+    const InterfaceInfo *findByIndex(int index) const;
+
+    /**
+     * @brief 按接口名查找
+     *
+     * @return 找不到返回NULL
+     */
+    const InterfaceInfo *findByName(const char *name) const;
+
+    /**
+     * @brief 获取接口的MTU
+     *
+     * @return 接口不存在时返回0
+     */
+    uint32_t getMtu(int index) const;
+
+    /**
+     * @brief addr是否为本机某个接口上的地址(端口和scope id不参与比较)
+     *
+     * @param sa 要检查的地址, IPv4映射的IPv6地址按IPv4地址检查
+     */
+    bool isLocalAddress(const sockaddr *sa) const;
+    bool isLocalAddress(const CompactSocketAddress &addr) const;
+
+    /**
+     * @brief 查找包含addr的最长前缀所在的接口地址, 即直连对端时使用的本地地址
+     *
+     * 只检查已启用(IFF_UP)接口上的地址, 本机地址(包括127.0.0.0/8)也会匹配.
+     *
+     * @param sa 对端地址, IPv4映射的IPv6地址按IPv4地址查找
+     *
+     * @return 找不到返回NULL, 对端不在任何直连网段上
+     */
+    const InterfaceAddress *findOnLink(const sockaddr *sa) const;
+
+    /**
+     * @brief 选择接口上的一个源地址: 可用的, 作用域最大(全局优先于链路本地)的第一个地址
+     *
+     * @param index 接口序号
+     * @param family AF_INET或AF_INET6
+     *
+     * @return 找不到返回NULL
+     */
+    const InterfaceAddress *findSourceAddress(int index, int family) const;
+
+private:
+    friend class InterfaceTable;
+
+    bool apply(const NetlinkMessage &msg);
+    InterfaceInfo *find(int index, bool create);
+    void apply(const LinkMessage &link);
+    void apply(const AddressMessage &addr);
+
+    uint64_t generation_ = 0;
+    std::vector<InterfaceInfo> interfaces_;
+};
+
+/**
+ * @brief 本机网络接口表: 创建时通过netlink dump一次, 之后由链路和地址的多播通知增量更新
+ *
+ * 每次变化都生成一个新的InterfaceSnapshot(写时复制)替换旧的. 读取时先比较全局的代号,
+ * 没有变化就直接使用本线程缓存的快照, 只有一次原子读, 不加锁, 也不修改共享的引用计数;
+ * 代号变化后本线程第一次读取时才取新的快照.
+ *
+ * 事件可以由start()启动的后台线程处理, 也可以把getNativeHandle()加入调用者自己的
+ * 事件循环, 在可读时调用processEvents(). 通知积压导致内核丢弃事件(ENOBUFS)时
+ * 自动重新dump.
+ *
+ * @code
+ * InterfaceTable &table = InterfaceTable::instance();     // 第一次调用时dump并启动后台线程
+ * if (table.current().isLocalAddress(peer.getSockaddr()))
+ *     ...
+ * uint32_t mtu = table.current().getMtu(ifindex);
+ * @endcode
+ *
+ * @note current()返回的引用在本线程下一次调用current()之前有效; 需要长期持有时用snapshot()
+ */
+class InterfaceTable {
+public:
+    /**
+     * @brief 打开netlink socket, 加入链路和地址多播组, 并dump当前的接口和地址
+     *
+     * @note 可能会抛出SocketException异常
+     */
+    InterfaceTable();
+
+    /**
+     * @brief 停止后台线程
+     */
+    ~InterfaceTable();
+
+    InterfaceTable(const InterfaceTable &) = delete;
+    InterfaceTable &operator =(const InterfaceTable &) = delete;
+
+    /**
+     * @brief 获取进程内共享的接口表, 第一次调用时创建并启动后台线程
+     */
+    static InterfaceTable &instance();
+
+    /**
+     * @brief 当前快照, 无锁, 使用本线程的缓存
+     *
+     * @return 快照的引用, 在本线程下一次调用current()之前有效
+     */
+    const InterfaceSnapshot &current() const;
+
+    /**
+     * @brief 当前快照的共享引用, 可以长期持有, 比current()慢
+     */
+    std::shared_ptr<const InterfaceSnapshot> snapshot() const;
+
+    /**
+     * @brief 当前的代号, 与缓存的代号比较可以知道接口或地址是否变化
+     */
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 启动后台线程处理netlink通知
+     */
+    void start();
+
+    /**
+     * @brief 停止后台线程
+     */
+    void stop();
+
+    /**
+     * @brief 处理所有已到达的通知, 不阻塞
+     *
+     * @return 接口表是否发生了变化
+     */
+    bool processEvents();
+
+    /**
+     * @brief 重新dump完整的接口和地址
+     */
+    void refresh();
+
+    /**
+     * @brief 接收通知的netlink socket, 用于加入调用者的事件循环
+     */
+    SOCKET getNativeHandle() const { return events_.getNativeHandle(); }
+
+private:
+    static bool dump(NetlinkSocket &sock, uint16_t type, std::vector<char> &buffer, InterfaceSnapshot &snapshot);
+    void load();
+    void publish(std::shared_ptr<InterfaceSnapshot> next);
+    void run();
+
+    NetlinkSocket events_;
+    std::shared_ptr<const InterfaceSnapshot> snapshot_;     // 通过std::atomic_load/atomic_store访问
+    std::atomic<uint64_t> generation_{0};
+    std::mutex updateMutex_;    // 写者之间互斥, 读者不使用
+    std::vector<char> buffer_;  // 接收缓冲区, 由updateMutex_保护
+    std::thread thread_;
+    int stopFd_ = -1;           // eventfd, 通知后台线程退出
+};
+
+}   // mini_socket
+
+#endif
+
+#endif
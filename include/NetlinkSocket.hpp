@@ -0,0 +1,455 @@
+/**
+ * @file NetlinkSocket.hpp
+ * @brief Netlink(rtnetlink) Socket, 以及直接引用接收缓冲区的消息/属性迭代器
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_NETLINK_SOCKET_INC
+#define MINI_SOCKET_NETLINK_SOCKET_INC
+
+#include "Socket.hpp"
+
+#if defined (__linux__)
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+namespace mini_socket {
+
+class NetlinkAttributes;
+
+/**
+ * @brief 一个netlink属性(rtattr), 指向接收缓冲区, 不拷贝数据
+ */
+class NetlinkAttribute {
+public:
+    explicit NetlinkAttribute(const rtattr *rta = NULL): rta_(rta) {}
+
+    /**
+     * @brief 是否指向一个有效的属性, NetlinkAttributes::find找不到时无效
+     */
+    bool isValid() const { return rta_ != NULL; }
+
+    /**
+     * @brief 属性类型, 已去掉NLA_F_NESTED等标志位
+     */
+    uint16_t type() const { return rta_->rta_type & NLA_TYPE_MASK; }
+
+    /**
+     * @brief 属性数据
+     */
+    const void *data() const { return RTA_DATA(rta_); }
+
+    /**
+     * @brief 属性数据的长度
+     */
+    size_t length() const { return RTA_PAYLOAD(rta_); }
+
+    /**
+     * @brief 以'\0'结尾的字符串属性(如IFLA_IFNAME), 格式不对时返回NULL
+     */
+    const char *getString() const
+    {
+        const char *s = (const char *) data();
+        return (length() > 0 && s[length() - 1] == '\0') ? s : NULL;
+    }
+
+    /**
+     * @brief 整数属性(主机字节序), 长度不对时返回0
+     */
+    uint8_t getU8() const { return get<uint8_t>(); }
+    uint16_t getU16() const { return get<uint16_t>(); }
+    uint32_t getU32() const { return get<uint32_t>(); }
+    uint64_t getU64() const { return get<uint64_t>(); }
+
+    /**
+     * @brief 嵌套属性(如IFLA_LINKINFO)中的属性
+     */
+    NetlinkAttributes nested() const;
+
+    const rtattr *get() const { return rta_; }
+
+private:
+    template <typename T>
+    T get() const
+    {
+        T v = 0;
+        if (length() == sizeof(T))
+            memcpy(&v, data(), sizeof(T));    // 属性只保证4字节对齐
+        return v;
+    }
+
+    const rtattr *rta_;
+};
+
+/**
+ * @brief 一段连续的属性, 可以用范围for遍历
+ */
+class NetlinkAttributes {
+public:
+    class iterator {
+    public:
+        iterator(const rtattr *rta = NULL, int remaining = 0): rta_(rta), remaining_(remaining) { skip(); }
+
+        NetlinkAttribute operator *() const { return NetlinkAttribute(rta_); }
+        iterator &operator ++()
+        {
+            rta_ = RTA_NEXT(rta_, remaining_);
+            skip();
+            return *this;
+        }
+        bool operator ==(const iterator &rhs) const { return rta_ == rhs.rta_; }
+        bool operator !=(const iterator &rhs) const { return !(*this == rhs); }
+
+    private:
+        // 到达末尾或遇到截断的属性时变成end()
+        void skip()
+        {
+            if (rta_ != NULL && !RTA_OK(rta_, remaining_))
+                rta_ = NULL;
+        }
+
+        const rtattr *rta_;
+        int remaining_;
+    };
+
+    NetlinkAttributes(const void *data = NULL, size_t len = 0): data_((const rtattr *) data), len_(len) {}
+
+    iterator begin() const { return iterator(data_, (int) len_); }
+    iterator end() const { return iterator(); }
+
+    /**
+     * @brief 查找指定类型的第一个属性
+     *
+     * @return 找不到时返回无效属性
+     */
+    NetlinkAttribute find(uint16_t type) const;
+
+    /**
+     * @brief 按类型建立索引, 与iproute2的parse_rtattr相同, 之后按类型直接访问
+     *
+     * @param[out] table 索引表, 有maxType + 1项, 没有出现的类型为NULL
+     * @param maxType 最大的属性类型, 如IFLA_MAX
+     */
+    void index(const rtattr **table, int maxType) const;
+
+private:
+    const rtattr *data_;
+    size_t len_;
+};
+
+inline NetlinkAttributes NetlinkAttribute::nested() const
+{
+    return NetlinkAttributes(data(), length());
+}
+
+/**
+ * @brief 一条netlink消息(nlmsghdr), 指向接收缓冲区, 缓冲区被覆盖后失效
+ */
+class NetlinkMessage {
+public:
+    explicit NetlinkMessage(const nlmsghdr *nh = NULL): nh_(nh) {}
+
+    const nlmsghdr *header() const { return nh_; }
+    uint16_t type() const { return nh_->nlmsg_type; }
+    uint16_t flags() const { return nh_->nlmsg_flags; }
+    uint32_t seq() const { return nh_->nlmsg_seq; }
+    uint32_t pid() const { return nh_->nlmsg_pid; }
+
+    /**
+     * @brief 消息体(nlmsghdr之后的数据)
+     */
+    const void *payload() const { return NLMSG_DATA(nh_); }
+    size_t payloadLength() const { return nh_->nlmsg_len - NLMSG_HDRLEN; }
+
+    /**
+     * @brief 把消息体的固定头部解释成T(如ifinfomsg), 长度不够时返回NULL
+     */
+    template <typename T>
+    const T *payloadAs() const
+    {
+        return payloadLength() >= sizeof(T) ? (const T *) payload() : NULL;
+    }
+
+    /**
+     * @brief 固定头部之后的属性
+     *
+     * @param headerLen 固定头部的长度, 如sizeof(ifinfomsg)
+     */
+    NetlinkAttributes attributes(size_t headerLen) const
+    {
+        size_t offset = NLMSG_ALIGN(headerLen);
+        if (payloadLength() < offset)
+            return NetlinkAttributes();
+        return NetlinkAttributes((const char *) payload() + offset, payloadLength() - offset);
+    }
+
+    /**
+     * @brief 是否为多部分消息(dump)的结束标志NLMSG_DONE
+     */
+    bool isDone() const { return nh_->nlmsg_type == NLMSG_DONE; }
+
+    /**
+     * @brief 是否为NLMSG_ERROR, 包括确认消息(错误码为0)
+     */
+    bool isError() const { return nh_->nlmsg_type == NLMSG_ERROR; }
+
+    /**
+     * @brief NLMSG_ERROR中的错误码
+     *
+     * @return 正的errno, 0表示确认(ACK)
+     */
+    int error() const
+    {
+        const nlmsgerr *err = payloadAs<nlmsgerr>();
+        return err != NULL ? -err->error : EPROTO;
+    }
+
+private:
+    const nlmsghdr *nh_;
+};
+
+/**
+ * @brief 一个netlink报文中的所有消息, 可以用范围for遍历, 遍历过程中没有拷贝
+ *
+ * @code
+ * int n = sock.recv(buf, sizeof(buf));
+ * for (NetlinkMessage msg: NetlinkMessages(buf, n)) {
+ *     LinkMessage link;
+ *     if (link.parse(msg))
+ *         ...
+ * }
+ * @endcode
+ */
+class NetlinkMessages {
+public:
+    class iterator {
+    public:
+        iterator(const nlmsghdr *nh = NULL, int remaining = 0): nh_(nh), remaining_(remaining) { skip(); }
+
+        NetlinkMessage operator *() const { return NetlinkMessage(nh_); }
+        iterator &operator ++()
+        {
+            nh_ = NLMSG_NEXT(nh_, remaining_);
+            skip();
+            return *this;
+        }
+        bool operator ==(const iterator &rhs) const { return nh_ == rhs.nh_; }
+        bool operator !=(const iterator &rhs) const { return !(*this == rhs); }
+
+    private:
+        void skip()
+        {
+            if (nh_ != NULL && !NLMSG_OK(nh_, remaining_))
+                nh_ = NULL;
+        }
+
+        const nlmsghdr *nh_;
+        int remaining_;
+    };
+
+    NetlinkMessages(const void *buffer, int len): buffer_((const nlmsghdr *) buffer), len_(len) {}
+
+    iterator begin() const { return iterator(buffer_, len_); }
+    iterator end() const { return iterator(); }
+
+private:
+    const nlmsghdr *buffer_;
+    int len_;
+};
+
+/**
+ * @brief RTM_NEWLINK/RTM_DELLINK消息中常用的字段, 字符串指向接收缓冲区
+ */
+struct LinkMessage {
+    bool isNew = false;         // RTM_NEWLINK: 新增或状态变化; RTM_DELLINK: 删除
+    int index = 0;              // 网络接口序号
+    unsigned flags = 0;         // IFF_UP, IFF_RUNNING等
+    unsigned change = 0;        // 本次变化的flags位
+    unsigned short linkType = 0;    // ARPHRD_ETHER等
+    const char *name = NULL;    // IFLA_IFNAME
+    uint32_t mtu = 0;           // IFLA_MTU
+    uint8_t operState = 0;      // IFLA_OPERSTATE, IF_OPER_UP等
+    const uint8_t *hwAddress = NULL;    // IFLA_ADDRESS
+    size_t hwAddressLen = 0;
+
+    /**
+     * @brief 从消息中提取字段
+     *
+     * @return 消息类型不对或格式错误时返回false
+     */
+    bool parse(const NetlinkMessage &msg);
+};
+
+/**
+ * @brief RTM_NEWADDR/RTM_DELADDR消息中常用的字段, 地址指向接收缓冲区
+ */
+struct AddressMessage {
+    bool isNew = false;
+    int family = AF_UNSPEC;     // AF_INET或AF_INET6
+    int index = 0;              // 网络接口序号
+    int prefixLen = 0;
+    int scope = 0;              // RT_SCOPE_UNIVERSE, RT_SCOPE_LINK等
+    unsigned flags = 0;         // IFA_F_*, 包括IFA_FLAGS属性中的扩展标志
+    const void *address = NULL; // 接口地址: IPv4为IFA_LOCAL, 没有时(以及IPv6)为IFA_ADDRESS
+    const char *label = NULL;   // IFA_LABEL, 只有IPv4有
+
+    bool parse(const NetlinkMessage &msg);
+
+    /**
+     * @brief 把接口地址转换成sockaddr, 端口为0, IPv6链路本地地址带上scope id
+     *
+     * @return sockaddr的长度, 没有地址时返回0
+     */
+    socklen_t toSockaddr(sockaddr_storage *ss) const;
+};
+
+/**
+ * @brief RTM_NEWROUTE/RTM_DELROUTE消息中常用的字段, 地址指向接收缓冲区
+ */
+struct RouteMessage {
+    bool isNew = false;
+    int family = AF_UNSPEC;
+    int dstLen = 0;             // 目的前缀长度
+    uint32_t table = 0;         // RTA_TABLE, 没有时为rtm_table
+    int protocol = 0;           // RTPROT_KERNEL, RTPROT_BOOT等
+    int scope = 0;
+    int type = 0;               // RTN_UNICAST, RTN_LOCAL等
+    const void *dst = NULL;     // RTA_DST, 默认路由时为NULL
+    const void *gateway = NULL; // RTA_GATEWAY
+    const void *prefSrc = NULL; // RTA_PREFSRC
+    int oif = 0;                // RTA_OIF, 出接口序号
+    uint32_t priority = 0;      // RTA_PRIORITY
+
+    bool parse(const NetlinkMessage &msg);
+};
+
+/**
+ * @brief Netlink Socket, 默认为NETLINK_ROUTE协议
+ *
+ * 监听接口变化的典型用法:
+ * @code
+ * NetlinkSocket sock(NetlinkSocket::GROUP_LINK | NetlinkSocket::GROUP_IPV4_ADDRESS);
+ * char buf[NetlinkSocket::RECV_BUFFER_SIZE];
+ * for ( ; ; ) {
+ *     int n = sock.recv(buf, sizeof(buf));
+ *     for (NetlinkMessage msg: NetlinkMessages(buf, n)) { ... }
+ * }
+ * @endcode
+ *
+ * @note 内核向多播组发送的速度超过接收速度时, recv会抛出SYSException(ENOBUFS),
+ *       此时已经丢失了事件, 应该重新dump一次完整状态
+ */
+class NetlinkSocket : public Socket {
+public:
+    /**
+     * @brief rtnetlink多播组, 可以按位组合
+     */
+    enum Group : uint32_t {
+        GROUP_LINK = RTMGRP_LINK,                   /**< 网络接口增删和状态变化 */
+        GROUP_IPV4_ADDRESS = RTMGRP_IPV4_IFADDR,    /**< IPv4地址变化 */
+        GROUP_IPV6_ADDRESS = RTMGRP_IPV6_IFADDR,    /**< IPv6地址变化 */
+        GROUP_IPV4_ROUTE = RTMGRP_IPV4_ROUTE,       /**< IPv4路由变化 */
+        GROUP_IPV6_ROUTE = RTMGRP_IPV6_ROUTE,       /**< IPv6路由变化 */
+    };
+
+    /// 推荐的单个报文接收缓冲区大小, 足以容纳内核一次发送的dump报文
+    static const int RECV_BUFFER_SIZE = 32768;
+
+    /// recvBatch单次最多接收的报文个数
+    static const int MAX_BATCH = 64;
+
+    NetlinkSocket() = default;
+
+    /**
+     * @brief 创建netlink socket, 并加入多播组
+     *
+     * @param groups 多播组, Group的按位组合, 0表示不加入
+     * @param protocol netlink协议, 如NETLINK_ROUTE
+     */
+    explicit NetlinkSocket(uint32_t groups, int protocol = NETLINK_ROUTE);
+
+    /**
+     * @brief 创建netlink socket并绑定(由内核分配端口号)
+     *
+     * @param protocol netlink协议
+     */
+    void open(int protocol = NETLINK_ROUTE);
+
+    /**
+     * @brief 加入多播组
+     *
+     * @param groups Group的按位组合
+     */
+    void subscribe(uint32_t groups);
+
+    /**
+     * @brief 退出多播组
+     *
+     * @param groups Group的按位组合
+     */
+    void unsubscribe(uint32_t groups);
+
+    /**
+     * @brief 获取内核分配的端口号(nl_pid), 内核发回的应答中带有这个端口号
+     */
+    uint32_t getPortId() const;
+
+    /**
+     * @brief 向内核发送请求
+     *
+     * @param type 消息类型, 如RTM_GETLINK
+     * @param flags 消息标志, 自动加上NLM_F_REQUEST
+     * @param payload 消息体
+     * @param payloadLen 消息体长度
+     *
+     * @return 请求的序列号, 应答消息的seq与之相同
+     */
+    uint32_t sendRequest(uint16_t type, uint16_t flags, const void *payload, size_t payloadLen);
+
+    /**
+     * @brief 请求dump一类对象的完整列表(如所有网络接口), 应答以NLMSG_DONE结束
+     *
+     * @param type RTM_GETLINK, RTM_GETADDR或RTM_GETROUTE等
+     * @param family 地址族, AF_UNSPEC表示所有
+     *
+     * @return 请求的序列号
+     */
+    uint32_t requestDump(uint16_t type, int family = AF_UNSPEC);
+
+    /**
+     * @brief 接收一个netlink报文, 报文中可能有多条消息
+     *
+     * @param buffer 接收数据缓存地址
+     * @param bufferLen 缓存长度, 推荐RECV_BUFFER_SIZE
+     *
+     * @return 接收数据长度
+     *
+     * @note 缓存不足以容纳整个报文时抛出SYSException(EMSGSIZE)
+     */
+    int recv(char *buffer, int bufferLen);
+
+    /**
+     * @brief 批量接收报文(recvmmsg), 阻塞直到第一个报文到达, 之后只取已在队列中的报文
+     *
+     * @param buffer 连续的缓存, 第i个报文存放在buffer + i * datagramLen
+     * @param datagramLen 每个报文的缓存长度
+     * @param count 最多接收的报文个数, 一次最多MAX_BATCH个
+     * @param[out] lens 每个报文的长度
+     *
+     * @return 接收到的报文个数
+     */
+    int recvBatch(char *buffer, int datagramLen, int count, int *lens);
+
+private:
+    uint32_t seq_ = 0;
+};
+
+}   // mini_socket
+#endif
+
+#endif
@@ -0,0 +1,190 @@
+/**
+ * @file PacketSocket.hpp
+ * @brief 基于AF_PACKET TPACKET_V3内存映射接收环的抓包Socket
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_PACKET_SOCKET_INC
+#define MINI_SOCKET_PACKET_SOCKET_INC
+
+#include "Socket.hpp"
+
+#if defined (__linux__)
+#include <cstdint>
+
+namespace mini_socket {
+
+/**
+ * @brief 接收环中的一个报文, 数据直接指向环形缓冲区, 所在的块归还后失效
+ */
+struct PacketFrame {
+    const char *data = 0;       // 从链路层头开始的报文数据
+    uint32_t captureLength = 0; // 实际捕获的长度
+    uint32_t wireLength = 0;    // 报文在链路上的原始长度
+    int64_t timestamp = 0;      // 内核接收时间戳, 纳秒
+    uint32_t rxhash = 0;        // 内核计算的流哈希
+};
+
+/**
+ * @brief 接收环中的一个块, 包含若干连续的报文
+ */
+class PacketBlock {
+public:
+    /**
+     * @brief 块内报文的迭代器, 遍历过程中没有系统调用
+     */
+    class iterator {
+    public:
+        iterator(const char *frame = 0, uint32_t remaining = 0): frame_(frame), remaining_(remaining) {}
+
+        PacketFrame operator *() const;
+        iterator &operator ++();
+        bool operator ==(const iterator &rhs) const { return remaining_ == rhs.remaining_; }
+        bool operator !=(const iterator &rhs) const { return !(*this == rhs); }
+
+    private:
+        const char *frame_;     // 当前报文的tpacket3_hdr
+        uint32_t remaining_;    // 包括当前报文在内剩余的报文个数
+    };
+
+    /**
+     * @brief 获取块内的报文个数
+     */
+    uint32_t frameCount() const;
+
+    iterator begin() const;
+    iterator end() const { return iterator(); }
+
+    /**
+     * @brief 是否指向一个有效的块
+     */
+    bool isValid() const { return desc_ != 0; }
+
+private:
+    friend class PacketSocket;
+    char *desc_ = 0;            // tpacket_block_desc
+};
+
+/**
+ * @brief PacketSocket接收环参数
+ *
+ * 默认的接收环为1MB x 64 = 64MB, 每个PacketSocket一个; 高速抓包时可以加大块大小,
+ * 但内存会尽量用MAP_LOCKED锁定, 多线程fanout时总量按线程数成倍增加.
+ */
+struct PacketRingConfig {
+    int blockSize = 1 << 20;    // 每个块的字节数, 必须是页大小的整数倍
+    int blockCount = 64;        // 块个数
+    int frameSize = 2048;       // 帧大小, 决定环的帧数上限, 必须是16的整数倍
+    int blockTimeout = 10;      // 块未满时最多等待多少毫秒就交给用户态
+};
+
+/**
+ * @brief 抓包Socket, 使用TPACKET_V3接收环, 报文按块批量交给用户态
+ *
+ * 典型用法:
+ * @code
+ * PacketSocket sock("lo");
+ * PacketBlock block;
+ * while (sock.nextBlock(block, 1000)) {
+ *     for (const PacketFrame &frame: block) { ... }
+ *     sock.releaseBlock(block);
+ * }
+ * @endcode
+ *
+ * @note 需要CAP_NET_RAW权限
+ */
+class PacketSocket : public Socket {
+public:
+    /**
+     * @brief fanout模式, 多个PacketSocket加入同一个组时内核在它们之间分配报文
+     */
+    enum FanoutMode {
+        FANOUT_HASH = 0,    /**< 按流哈希分配, 同一个流总是到同一个socket */
+        FANOUT_LB = 1,      /**< 轮流分配 */
+        FANOUT_CPU = 2,     /**< 按接收报文的CPU分配 */
+    };
+
+    /**
+     * @brief 收包统计
+     */
+    struct Statistics {
+        uint32_t packets = 0;       // 收到的报文数
+        uint32_t drops = 0;         // 因接收环满而丢弃的报文数
+        uint32_t freezeCount = 0;   // 接收环被用户态占满的次数
+    };
+
+    PacketSocket() = default;
+
+    /**
+     * @brief 创建抓包Socket并建立接收环
+     *
+     * @param ifname 网卡名, 为NULL时抓取所有网卡
+     * @param config 接收环参数
+     */
+    PacketSocket(const char *ifname, const PacketRingConfig &config = PacketRingConfig());
+
+    /**
+     * @brief 解除接收环映射并关闭socket
+     */
+    ~PacketSocket();
+
+    /**
+     * @brief 打开抓包Socket, 建立接收环并绑定到网卡
+     *
+     * @param ifname 网卡名, 为NULL时抓取所有网卡
+     * @param config 接收环参数
+     */
+    void open(const char *ifname, const PacketRingConfig &config = PacketRingConfig());
+
+    /**
+     * @brief 解除接收环映射并关闭socket
+     */
+    void close() override;
+
+    /**
+     * @brief 加入fanout组, 组内的多个socket(通常每个线程一个)分担报文
+     *
+     * @param groupId 组号, 同一个网卡上相同组号的socket属于同一组
+     * @param mode 分配模式
+     */
+    void joinFanout(uint16_t groupId, FanoutMode mode = FANOUT_HASH);
+
+    /**
+     * @brief 获取下一个已就绪的块, 块就绪时不需要系统调用
+     *
+     * @param[out] block 返回的块
+     * @param timeoutMs 没有就绪的块时最多等待的毫秒数, -1表示一直等待
+     *
+     * @return 获取到块返回true; 超时返回false
+     *
+     * @note 处理完后必须调用releaseBlock把块还给内核, 一次只能持有一个块
+     */
+    bool nextBlock(PacketBlock &block, int timeoutMs);
+
+    /**
+     * @brief 把块还给内核
+     *
+     * @param block nextBlock返回的块
+     */
+    void releaseBlock(PacketBlock &block);
+
+    /**
+     * @brief 获取并清零收包统计
+     *
+     * @return 自上次调用以来的统计
+     */
+    Statistics getStatistics();
+
+private:
+    char *ring_ = 0;            // mmap的接收环
+    size_t ringSize_ = 0;
+    int blockSize_ = 0;
+    int blockCount_ = 0;
+    int current_ = 0;           // 下一个要读取的块
+};
+
+}   // mini_socket
+#endif
+
+#endif
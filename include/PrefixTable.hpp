@@ -0,0 +1,114 @@
+/**
+ * @file PrefixTable.hpp
+ * @brief IPv4/IPv6地址前缀(CIDR)的最长前缀匹配表
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_PREFIX_TABLE_INC
+#define MINI_SOCKET_PREFIX_TABLE_INC
+
+#include <cstdint>
+#include <vector>
+#include "SocketCommon.hpp"
+
+namespace mini_socket {
+
+class SocketAddress;
+class SocketAddressView;
+
+/**
+ * @brief CIDR前缀到整数值的最长前缀匹配表, 用于访问控制, QoS分类等
+ *
+ * 实现为步长8位的多分支trie, 前缀在所在的层内展开: IPv4查找最多访问4个节点,
+ * IPv6最多16个. 每个节点2KB, 一条前缀最多新建(前缀长度 / 8)个节点, 共享高位的前缀
+ * 共用节点: 上千条IPv4前缀通常只占用几MB; 但互不共享的IPv6 /128前缀每条要16个节点
+ * (32KB), 上千条就要几十MB.
+ *
+ * 典型用法是加载配置时构造好, 然后只读地在多个线程中查找; 查找与插入不能并发,
+ * 重新加载时构造一个新表再替换.
+ *
+ * @code
+ * PrefixTable acl;
+ * acl.insert("10.0.0.0/8", ALLOW);
+ * acl.insert("10.1.2.0/24", DENY);
+ * server.setAcceptFilter([&acl](const SocketAddressView &peer) {
+ *     return acl.lookup(peer) == ALLOW;
+ * });
+ * @endcode
+ */
+class PrefixTable {
+public:
+    static const int NO_MATCH = -1;     ///< 没有匹配的前缀
+
+    PrefixTable();
+
+    /**
+     * @brief 插入一个CIDR前缀
+     *
+     * @param cidr "a.b.c.d/len"或"ipv6/len"形式的字符串, 省略"/len"表示单个地址
+     * @param value 前缀对应的值, 必须大于等于0
+     *
+     * @return 格式正确返回true; 否则返回false
+     *
+     * @note 前缀长度之外的地址位被忽略; 相同的前缀再次插入时覆盖原来的值
+     */
+    bool insert(const char *cidr, int value);
+
+    /**
+     * @brief 插入一个前缀
+     *
+     * @param sa 前缀的地址部分
+     * @param prefixLen 前缀长度, IPv4为0~32, IPv6为0~128
+     * @param value 前缀对应的值, 必须大于等于0
+     *
+     * @return 地址族和前缀长度有效返回true; 否则返回false
+     */
+    bool insert(const sockaddr *sa, int prefixLen, int value);
+
+    /**
+     * @brief 查找与地址匹配的最长前缀
+     *
+     * @param sa 要查找的地址, IPv4映射的IPv6地址(::ffff:a.b.c.d)按IPv4地址查找
+     *
+     * @return 最长匹配前缀的值, 没有匹配时返回NO_MATCH
+     */
+    int lookup(const sockaddr *sa) const;
+
+    int lookup(const SocketAddress &addr) const;
+
+    int lookup(const SocketAddressView &addr) const;
+
+    /**
+     * @brief 删除所有前缀
+     */
+    void clear();
+
+private:
+    struct Slot {
+        int32_t  value;         // 该槽位上最长前缀的值, -1表示没有
+        uint32_t child : 24;    // 下一层节点的下标, 0表示没有(0号节点是根)
+        uint32_t len : 8;       // value对应的前缀长度
+    };
+
+    struct Node {
+        Slot slots[256];
+        Node();
+    };
+
+    struct Trie {
+        std::vector<Node> nodes;
+        int defaultValue;       // 长度为0的前缀
+
+        Trie(): nodes(1), defaultValue(NO_MATCH) {}
+        void insert(const uint8_t *addr, int prefixLen, int value);
+        int lookup(const uint8_t *addr, int depth) const;
+    };
+
+    Trie v4_;
+    Trie v6_;
+};
+
+}   // mini_socket
+
+#endif
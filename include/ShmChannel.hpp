@@ -0,0 +1,139 @@
+/**
+ * @file ShmChannel.hpp
+ * @brief 基于共享内存环形缓冲区的同主机进程间通道
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_SHM_CHANNEL_INC
+#define MINI_SOCKET_SHM_CHANNEL_INC
+
+#if defined (__linux__)
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "CommunicatingSocket.hpp"
+#include "UnixSocket.hpp"
+
+namespace mini_socket {
+
+/**
+ * @brief 同主机进程(或线程)间的双向字节流通道, 语义与TCP/Unix域字节流socket相同
+ *
+ * 两个方向各有一个memfd共享内存中的单生产者单消费者环形缓冲区, 收发数据不经过内核,
+ * 只有对端正在睡眠等待时才通过futex唤醒它. 建立连接时通过Unix域socket传递memfd
+ * (SCM_RIGHTS), 之后这个Unix域socket只用来感知对端进程异常退出.
+ *
+ * 继承自CommunicatingSocket并重写了send/recv, 基于CommunicatingSocket编写的处理函数
+ * (如str_echo)可以不加修改地运行在ShmChannel上.
+ *
+ * @note 每个方向同时只能有一个线程发送, 一个线程接收; 不支持connect, 带时间戳的recv,
+ *       setNonBlocking等作用于底层socket的操作
+ */
+class ShmChannel : public CommunicatingSocket {
+public:
+    static const size_t DEFAULT_RING_SIZE = 1 << 20;   ///< 默认的单向缓冲区大小
+
+    ShmChannel() = default;
+
+    /**
+     * @brief 连接到ShmChannel::accept所在的Unix域地址, 并创建共享内存
+     *
+     * @param foreignAddress 服务器端地址, 见make_unix_address
+     * @param ringSize 单向缓冲区大小, 向上取整为2的幂(4KB~1GB)
+     *
+     * @note 可能会抛出SocketException异常
+     */
+    explicit ShmChannel(const SocketAddress &foreignAddress, size_t ringSize = DEFAULT_RING_SIZE);
+
+    ~ShmChannel();
+
+    /**
+     * @brief 关闭通道: 设置关闭标志并立即唤醒阻塞在send/recv中的对端, 然后解除映射并关闭socket
+     *
+     * 对端之后的recv在读完剩余数据后返回0, send抛出SYSException(EPIPE).
+     *
+     * @note 不能与本端的send/recv并发调用
+     */
+    void close() override;
+
+    /**
+     * @brief 从UnixServerSocket接受一个连接, 并映射对端创建的共享内存
+     *
+     * @param server 监听的Unix域字节流socket
+     *
+     * @return 已连接的通道
+     */
+    static std::shared_ptr<ShmChannel> accept(UnixServerSocket &server);
+
+    /**
+     * @brief 创建一对互相连接的通道, 用于线程之间, 或在fork之前创建
+     *
+     * fork之后各进程中不使用的一端要用::close(release())关闭: Socket::close会shutdown
+     * 底层的Unix域socket, 另一个进程会认为对端已关闭.
+     *
+     * @param[out] first 第一个通道
+     * @param[out] second 第二个通道
+     * @param ringSize 单向缓冲区大小
+     */
+    static void pair(ShmChannel &first, ShmChannel &second, size_t ringSize = DEFAULT_RING_SIZE);
+
+    /**
+     * @brief 发送数据, 缓冲区满时阻塞, 直到有空间或对端关闭
+     *
+     * @return 发送出的数据长度, 可能小于bufferLen
+     *
+     * @note 对端已关闭时抛出SYSException(EPIPE)
+     */
+    int send(const char *buffer, int bufferLen) override;
+
+    /**
+     * @brief 接收数据, 缓冲区空时阻塞, 直到有数据或对端关闭
+     *
+     * @return 接收数据长度, 0表示对端已关闭, 且之前发送的数据都已读完
+     */
+    int recv(char *buffer, int bufferLen) override;
+
+    /**
+     * @brief 设置睡眠之前自旋检查的次数
+     *
+     * @param count 自旋次数, 0表示不自旋; 默认在多CPU系统上为1000, 单CPU系统上为0
+     */
+    void setSpinCount(int count) { spinCount_ = count; }
+
+    /**
+     * @brief 获取单向缓冲区大小
+     */
+    size_t getRingSize() const { return ringSize_; }
+
+private:
+    struct RingControl;
+
+    void handshake(UnixStreamSocket &control, size_t ringSize);
+    void acceptHandshake(UnixStreamSocket &control);
+    void map(int memfd, size_t ringSize, bool initiator);
+    void unmap();
+    bool sleep(RingControl *control, std::atomic<uint32_t> &waiting,
+            const std::atomic<uint32_t> &position, uint32_t value);
+
+    void *mem_ = nullptr;       // 共享内存映射
+    size_t memSize_ = 0;
+    size_t ringSize_ = 0;
+    RingControl *txControl_ = nullptr;  // 本端发送的方向
+    RingControl *rxControl_ = nullptr;  // 本端接收的方向
+    char *txData_ = nullptr;
+    char *rxData_ = nullptr;
+    uint32_t txHead_ = 0;       // 本地保存的发送位置, 只有本端修改
+    uint32_t txTailCache_ = 0;  // 最近一次读到的对端消费位置, 减少读取对端的缓存行
+    uint32_t rxTail_ = 0;
+    uint32_t rxHeadCache_ = 0;
+    int spinCount_ = 0;
+};
+
+}   // mini_socket
+
+#endif
+
+#endif
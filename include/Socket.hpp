@@ -8,9 +8,11 @@
 #ifndef MINI_SOCKET_SOCKET_INC
 #define MINI_SOCKET_SOCKET_INC
 
+#include <functional>
 #include <memory>
 #include "SocketCommon.hpp"
 #include "SocketAddress.hpp"
+#include "SocketAddressView.hpp"
 #include "SocketError.hpp"
 
 #if defined (WIN32) || defined (_WIN32)
@@ -40,6 +42,13 @@ typedef int SOCKET;
 
 namespace mini_socket {
 
+/**
+ * @brief 对端地址过滤器, 返回false表示丢弃来自该对端的连接或报文
+ *
+ * @note 在接收路径上调用, 应当只做查表之类的轻量操作, 不能抛出异常
+ */
+typedef std::function<bool (const SocketAddressView &peer)> PeerFilter;
+
 /**
  * @brief 封装socket文件描述符的类, 所有具体socket功能类的基类
  */
@@ -71,8 +80,11 @@ public:
 
     /**
      * @brief 关闭socket
+     *
+     * @note 虚函数: 持有映射内存等额外资源的子类重写它, 通过Socket的指针或引用关闭时也会释放这些资源.
+     *       析构函数中的调用不会分派到子类, 子类的析构函数要自己释放
      */
-    void close();
+    virtual void close();
 
     /**
      * @brief 判断当前socket是否已打开
@@ -95,6 +107,79 @@ public:
      */
     void bind(const SocketAddress &localAddress);
 
+    /**
+     * @brief 设置接收缓冲区大小(SO_RCVBUF)
+     *
+     * @param size 缓冲区字节数
+     */
+    void setReceiveBufferSize(int size);
+
+    /**
+     * @brief 设置发送缓冲区大小(SO_SNDBUF)
+     *
+     * @param size 缓冲区字节数
+     */
+    void setSendBufferSize(int size);
+
+    /**
+     * @brief 设置非阻塞模式
+     *
+     * @param on 是否开启
+     */
+    void setNonBlocking(bool on);
+
+    /**
+     * @brief 获取底层socket描述符, 用于poll/epoll等事件接口
+     *
+     * @return socket描述符, 所有权仍然属于当前对象
+     */
+    SOCKET getNativeHandle() const { return sockDesc_; }
+
+    /**
+     * @brief 接管一个已打开的socket描述符, 之后由当前对象负责关闭
+     *
+     * @param sockDesc socket描述符, 如从其他进程传递过来的描述符(见UnixStreamSocket::recvSocket)
+     *
+     * @note 当前对象已打开时先关闭原来的描述符
+     */
+    void assign(SOCKET sockDesc);
+
+    /**
+     * @brief 放弃socket描述符的所有权, 当前对象变为未打开状态
+     *
+     * @return socket描述符, 由调用者负责关闭
+     */
+    SOCKET release();
+
+#if defined (__linux__)
+    /**
+     * @brief 允许多个socket绑定同一个地址(SO_REUSEPORT), 内核按四元组在它们之间分发
+     *
+     * @param on 是否开启
+     *
+     * @note 必须在bind之前调用
+     */
+    void setReusePort(bool on);
+
+    /**
+     * @brief 开启内核接收时间戳, 之后可以通过带SocketTimestamp参数的接收接口获取
+     *
+     * @param hardware 是否同时请求网卡硬件时间戳
+     *
+     * @note 优先使用SO_TIMESTAMPING, 内核不支持时退回到SO_TIMESTAMPNS(只有软件时间戳)
+     */
+    void enableTimestamping(bool hardware = false);
+
+    /**
+     * @brief 等待socket可读
+     *
+     * @param timeoutMs 最多等待的毫秒数, -1表示一直等待
+     *
+     * @return 可读(或出错, 接下来的接收会返回错误)返回true; 超时返回false
+     */
+    bool waitReadable(int timeoutMs);
+#endif
+
 private:
     Socket(const Socket &sock) = delete;
     void operator=(const Socket &sock) = delete;
@@ -8,6 +8,7 @@
 #ifndef MINI_SOCKET_SOCKET_ADDRESS_INC
 #define MINI_SOCKET_SOCKET_ADDRESS_INC
 
+#include <iosfwd>
 #include <string>
 #include <tuple>
 #include "SocketCommon.hpp"
@@ -48,10 +49,23 @@ public:
      * @param address ip地址的字符串
      * @param port 端口号
      *
-     * @return 如果是有效地址, 返回true; 否则返回false
+     * @return 如果是有效地址, 返回true; 否则返回false, SocketAddress保持不变
+     *
+     * @note IPv6地址可以带"%scope"后缀, 见parse_address
      */
     bool setAddressPort(const char *address, uint16_t port); 
 
+    /**
+     * @brief 根据"ip:port"或"[ipv6]:port"形式的字符串重新设置一个SocketAddress
+     *
+     * @param addressPort 地址和端口的字符串
+     *
+     * @return 如果是有效地址, 返回true; 否则返回false, SocketAddress保持不变
+     *
+     * @note 需要区分错误原因时使用parse_address_port
+     */
+    bool setAddressPort(const char *addressPort);
+
     /**
      * @brief 将SocketAddress转换成可打印格式
      *
@@ -59,6 +73,16 @@ public:
      */
     std::string toString() const;
 
+    /**
+     * @brief 将SocketAddress格式化到调用者提供的缓冲区中, 不分配内存
+     *
+     * @param buf 输出缓冲区, 结果以'\0'结尾
+     * @param len 输出缓冲区的长度, ADDRESS_PORT_STRLEN总是足够
+     *
+     * @return 写入的字符数(不含'\0'); 地址无效或缓冲区不足时返回0
+     */
+    size_t format(char *buf, size_t len) const;
+
     /**
      * @brief 获取可打印地址和port号
      *
@@ -92,6 +116,11 @@ private:
     socklen_t addrLen_ = sizeof(addr_);
 };
 
+/**
+ * @brief 以toString()的格式输出SocketAddress, 不经过std::string
+ */
+std::ostream &operator <<(std::ostream &os, const SocketAddress &addr);
+
 }   // mini_socket
 
 #endif
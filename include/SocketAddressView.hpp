@@ -8,6 +8,7 @@
 #ifndef MINI_SOCKET_SOCKET_ADDRESS_VIEW_INC
 #define MINI_SOCKET_SOCKET_ADDRESS_VIEW_INC
 
+#include <iosfwd>
 #include <string>
 #include <tuple>
 #include "SocketCommon.hpp"
@@ -35,6 +36,16 @@ public:
      */
     std::string toString() const;
 
+    /**
+     * @brief 将SocketAddressView格式化到调用者提供的缓冲区中, 不分配内存
+     *
+     * @param buf 输出缓冲区, 结果以'\0'结尾
+     * @param len 输出缓冲区的长度, ADDRESS_PORT_STRLEN总是足够
+     *
+     * @return 写入的字符数(不含'\0'); 地址无效或缓冲区不足时返回0
+     */
+    size_t format(char *buf, size_t len) const;
+
     /**
      * @brief 获取可打印地址和port号
      *
@@ -68,6 +79,11 @@ private:
     socklen_t addrLen_ = 0;
 };
 
+/**
+ * @brief 以toString()的格式输出SocketAddressView, 不经过std::string
+ */
+std::ostream &operator <<(std::ostream &os, const SocketAddressView &addr);
+
 }   // mini_socket
 
 #endif
@@ -19,16 +19,23 @@
 #include <netdb.h>
 #endif
 
+#include <cstddef>
 #include <string>
 #include <tuple>
 
 namespace mini_socket {
 
+/// format_address_port所需的缓冲区长度, 足以容纳"[ipv6]:port"或Unix域socket路径(最长108字节)和结尾的'\0'
+const size_t ADDRESS_PORT_STRLEN = 112;
+
 /// IP版本号
 enum class NetworkLayerType {
     UNKNOWN = UINT16_MAX,   /**< 未知协议 */
     IPv4 = AF_INET,         /**< IPv4协议 */
     IPv6 = AF_INET6,        /**< IPv6协议 */
+#if !defined (WIN32) && !defined (_WIN32)
+    UNIX = AF_UNIX,         /**< Unix域协议(本机通信) */
+#endif
 };
 
 /// 传输层协议类型
@@ -38,6 +45,14 @@ enum class TransportLayerType {
     UDP = SOCK_DGRAM,       /**< UDP协议 */
 };
 
+/// 地址字面量的解析结果
+enum class ParseAddressResult {
+    OK = 0,                 /**< 解析成功 */
+    INVALID_ADDRESS,        /**< 不是合法的IPv4/IPv6地址 */
+    INVALID_PORT,           /**< 端口号缺失或超出范围 */
+    INVALID_SCOPE,          /**< IPv6的scope id不是数字, 也不是存在的网络接口名 */
+};
+
 /**
  * @brief 将sockaddr地址转换成ip+port的tuple
  *
@@ -58,6 +73,68 @@ std::tuple<std::string, uint16_t> get_address_port(const sockaddr *sa, socklen_t
  */
 std::string to_string(const sockaddr *sa, socklen_t salen);
 
+/**
+ * @brief 将sockaddr中的ip地址格式化到调用者提供的缓冲区中, 不分配内存
+ *
+ * @param sa sockaddr地址的指针
+ * @param salen sockaddr地址的长度
+ * @param buf 输出缓冲区, 结果以'\0'结尾
+ * @param len 输出缓冲区的长度, INET6_ADDRSTRLEN总是足够
+ *
+ * @return 写入的字符数(不含'\0'); 地址族未知或缓冲区不足时返回0
+ *
+ * @note IP地址的输出与inet_ntop一致; Unix域地址输出路径, 抽象地址输出"@name",
+ *       未命名的地址返回0
+ */
+size_t format_address(const sockaddr *sa, socklen_t salen, char *buf, size_t len);
+
+/**
+ * @brief 将sockaddr地址格式化到调用者提供的缓冲区中, 不分配内存
+ *
+ * @param sa sockaddr地址的指针
+ * @param salen sockaddr地址的长度
+ * @param buf 输出缓冲区, 结果以'\0'结尾
+ * @param len 输出缓冲区的长度, ADDRESS_PORT_STRLEN总是足够
+ *
+ * @return 写入的字符数(不含'\0'); 地址族未知或缓冲区不足时返回0
+ *
+ * @note 格式与to_string相同, ipv4: xxx.xxx.xxx.xxx:port, ipv6: [xxx:xxx:...:xxx]:port,
+ *       Unix域地址与format_address相同
+ */
+size_t format_address_port(const sockaddr *sa, socklen_t salen, char *buf, size_t len);
+
+/**
+ * @brief 解析ip地址字面量, 不抛出异常, 不分配内存
+ *
+ * 支持点分十进制的IPv4地址, 以及带"::"压缩, 末尾内嵌IPv4地址, "%scope"后缀
+ * (数字或网络接口名)的IPv6地址; 除scope id外, 接受的格式与inet_pton相同.
+ *
+ * @param str 地址字符串, 不要求以'\0'结尾
+ * @param len 地址字符串的长度
+ * @param port 端口号(主机字节序)
+ * @param ss 输出的sockaddr, 只在解析成功时写入
+ * @param salen 输出的sockaddr实际长度, 只在解析成功时写入
+ *
+ * @return 解析结果
+ */
+ParseAddressResult parse_address(const char *str, size_t len, uint16_t port,
+        sockaddr_storage *ss, socklen_t *salen);
+
+/**
+ * @brief 解析"ip:port"或"[ipv6]:port"形式的地址字面量, 不抛出异常, 不分配内存
+ *
+ * @param str 地址字符串, 不要求以'\0'结尾
+ * @param len 地址字符串的长度
+ * @param ss 输出的sockaddr, 只在解析成功时写入
+ * @param salen 输出的sockaddr实际长度, 只在解析成功时写入
+ *
+ * @return 解析结果
+ *
+ * @note IPv6地址必须放在方括号中
+ */
+ParseAddressResult parse_address_port(const char *str, size_t len,
+        sockaddr_storage *ss, socklen_t *salen);
+
 /**
  * @brief 获取sockaddr地址的IP版本号
  *
@@ -0,0 +1,179 @@
+/**
+ * @file SocketDiag.hpp
+ * @brief 通过NETLINK_SOCK_DIAG(inet_diag)批量查询TCP/UDP socket的内核状态
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-19
+ */
+#ifndef MINI_SOCKET_SOCKET_DIAG_INC
+#define MINI_SOCKET_SOCKET_DIAG_INC
+
+#if defined (__linux__)
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <linux/inet_diag.h>
+#include <linux/sock_diag.h>
+#include "CompactSocketAddress.hpp"
+#include "NetlinkSocket.hpp"
+
+namespace mini_socket {
+
+/**
+ * @brief 查询条件, 端口和状态在内核中过滤
+ */
+struct SocketDiagQuery {
+    int family = AF_INET;           // AF_INET, AF_INET6, 或AF_UNSPEC(两个都查, 需要两次dump)
+    int protocol = IPPROTO_TCP;     // IPPROTO_TCP或IPPROTO_UDP
+    uint32_t states = 0xfff;        // 1 << TCP_ESTABLISHED等的组合, 默认为所有状态
+    uint16_t localPort = 0;         // 本端端口, 0表示不过滤
+    uint16_t remotePort = 0;        // 对端端口, 0表示不过滤
+    unsigned extensions = 0;        // SocketDiag::EXT_*的组合, 需要附带的信息
+};
+
+/**
+ * @brief 一个socket的诊断信息
+ */
+struct SocketDiagEntry {
+    int family = AF_UNSPEC;
+    int protocol = 0;
+    int state = 0;                  // TCP_ESTABLISHED, TCP_LISTEN等; 未连接的UDP socket为TCP_CLOSE
+    CompactSocketAddress localAddress;
+    CompactSocketAddress remoteAddress;
+    uint32_t inode = 0;             // socket的inode, TIME_WAIT和SYN_RECV状态为0
+    uint32_t uid = 0;
+    uint64_t cookie = 0;            // 内核中socket的唯一标识
+    uint32_t recvQueue = 0;         // 接收队列中的字节数; LISTEN状态为等待accept的连接数
+    uint32_t sendQueue = 0;         // 发送队列中的字节数; LISTEN状态为backlog
+
+    bool hasTcpInfo = false;        // 需要EXT_TCP_INFO, 只有TCP有
+    tcp_info tcpInfo = {};          // 与getsockopt(TCP_INFO)相同, 内核较旧时末尾的字段为0
+
+    bool hasMemInfo = false;        // 需要EXT_MEMINFO
+    uint32_t memInfo[SK_MEMINFO_VARS] = {};     // 以SK_MEMINFO_RMEM_ALLOC等为下标, 与ss -m相同
+
+    char congestion[16] = {};       // 拥塞控制算法名, 需要EXT_CONGESTION
+};
+
+/**
+ * @brief 一次查询的结果, 可以按socket的inode查找
+ *
+ * 按inode查找时不需要对每个socket做系统调用: 创建socket时用SocketDiag::getInode
+ * 取一次inode保存下来, 之后每次查询都用findByInode对应到自己的socket上.
+ */
+class SocketDiagResult {
+public:
+    const std::vector<SocketDiagEntry> &entries() const { return entries_; }
+
+    size_t size() const { return entries_.size(); }
+
+    /**
+     * @brief 按inode查找
+     *
+     * @return 找不到返回NULL
+     */
+    const SocketDiagEntry *findByInode(uint32_t inode) const;
+
+    /**
+     * @brief 按socket查找, 每次调用一次fstat, 频繁调用时应当缓存inode并使用findByInode
+     *
+     * @return 找不到返回NULL
+     */
+    const SocketDiagEntry *find(const Socket &sock) const;
+
+    /**
+     * @brief 清空结果, 保留已分配的内存
+     */
+    void clear();
+
+private:
+    friend class SocketDiag;
+
+    void add(const SocketDiagEntry &entry);
+
+    std::vector<SocketDiagEntry> entries_;
+    std::unordered_map<uint32_t, size_t> byInode_;  // inode -> entries_的下标
+};
+
+/**
+ * @brief NETLINK_SOCK_DIAG查询, 功能与ss相同, 但不需要创建进程和解析文本
+ *
+ * 每个地址族一次dump请求, 内核按状态和端口过滤后, 把所有匹配的socket连同请求的
+ * tcp_info, 内存信息一起返回; 不需要对每个socket调用getsockopt.
+ *
+ * @code
+ * SocketDiag diag;
+ * SocketDiagQuery query;
+ * query.localPort = 8080;
+ * query.states = 1 << TCP_ESTABLISHED;
+ * query.extensions = SocketDiag::EXT_TCP_INFO | SocketDiag::EXT_MEMINFO;
+ * SocketDiagResult result;
+ * diag.query(query, result);
+ * for (Connection &conn: connections) {
+ *     const SocketDiagEntry *entry = result.findByInode(conn.inode);
+ *     if (entry != NULL && entry->hasTcpInfo)
+ *         report(conn, entry->tcpInfo.tcpi_rtt, entry->tcpInfo.tcpi_total_retrans);
+ * }
+ * @endcode
+ *
+ * @note 只能看到本网络命名空间中的socket; 同一个SocketDiag不能在多个线程中同时使用
+ */
+class SocketDiag {
+public:
+    /**
+     * @brief 需要附带的信息, 可以按位组合
+     */
+    enum Extension : unsigned {
+        EXT_MEMINFO = 1u << (INET_DIAG_SKMEMINFO - 1),  /**< socket内存使用(memInfo) */
+        EXT_TCP_INFO = 1u << (INET_DIAG_INFO - 1),      /**< tcp_info */
+        EXT_CONGESTION = 1u << (INET_DIAG_CONG - 1),    /**< 拥塞控制算法名 */
+    };
+
+    /**
+     * @brief 打开NETLINK_SOCK_DIAG socket
+     *
+     * @note 可能会抛出SocketException异常
+     */
+    SocketDiag();
+
+    /**
+     * @brief 查询满足条件的socket, 结果追加到result中
+     *
+     * @param query 查询条件
+     * @param[out] result 查询结果
+     *
+     * @note 可能会抛出SocketException异常; 查询UDP需要内核的udp_diag模块, 没有时为ENOENT
+     */
+    void query(const SocketDiagQuery &query, SocketDiagResult &result);
+
+    /**
+     * @brief 查询满足条件的socket, 逐个交给回调函数, 不保存结果
+     *
+     * @param query 查询条件
+     * @param callback 回调函数, 参数只在调用期间有效
+     *
+     * @return 匹配的socket个数
+     */
+    int query(const SocketDiagQuery &query, const std::function<void (const SocketDiagEntry &)> &callback);
+
+    /**
+     * @brief 获取socket的inode, 用于和SocketDiagEntry::inode对应
+     */
+    static uint32_t getInode(const Socket &sock);
+
+private:
+    int dump(int family, const SocketDiagQuery &query, const std::function<void (const SocketDiagEntry &)> &callback);
+
+    NetlinkSocket sock_;
+    std::vector<char> buffer_;
+};
+
+}   // mini_socket
+
+#endif
+
+#endif
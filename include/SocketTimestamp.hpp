@@ -0,0 +1,63 @@
+/**
+ * @file SocketTimestamp.hpp
+ * @brief 内核收发时间戳(SO_TIMESTAMPNS / SO_TIMESTAMPING)
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_SOCKET_TIMESTAMP_INC
+#define MINI_SOCKET_SOCKET_TIMESTAMP_INC
+
+#include <cstdint>
+#include "SocketCommon.hpp"
+
+namespace mini_socket {
+
+/**
+ * @brief 内核给出的报文时间戳, 单位为纳秒(自1970-01-01 00:00:00 UTC起)
+ *
+ * @note 软件时间戳是协议栈收到(或发出)报文的时间, 硬件时间戳是网卡打的时间戳,
+ *       只有网卡和驱动支持时才会有值.
+ */
+struct SocketTimestamp {
+    /**
+     * @brief 时间戳类型
+     */
+    enum Type {
+        RECEIVED = 0,       /**< 接收时间戳 */
+        SCHEDULED = 1,      /**< 发送: 报文进入qdisc的时间 */
+        SENT = 2,           /**< 发送: 报文交给网卡驱动的时间 */
+        ACKED = 3,          /**< 发送: TCP收到对端确认的时间 */
+    };
+
+    int64_t software = 0;   // 软件时间戳, 0表示没有
+    int64_t hardware = 0;   // 硬件时间戳, 0表示没有
+    int type = RECEIVED;    // 时间戳类型
+    uint32_t id = 0;        // 发送时间戳对应的字节(TCP)或报文(UDP)序号
+
+    /**
+     * @brief 是否有软件时间戳
+     */
+    bool hasSoftware() const { return software != 0; }
+
+    /**
+     * @brief 是否有硬件时间戳
+     */
+    bool hasHardware() const { return hardware != 0; }
+};
+
+#if defined (__linux__)
+/**
+ * @brief 从recvmsg返回的控制消息中提取时间戳
+ *
+ * @param msg recvmsg填充过的msghdr
+ * @param[out] ts 返回时间戳
+ *
+ * @return 如果找到任何时间戳返回true; 否则返回false
+ */
+bool get_socket_timestamp(const msghdr *msg, SocketTimestamp &ts);
+#endif
+
+}   // mini_socket
+
+#endif
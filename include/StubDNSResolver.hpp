@@ -0,0 +1,104 @@
+/**
+ * @file StubDNSResolver.hpp
+ * @brief 内置的DNS存根解析器: 直接向resolv.conf中的域名服务器发送查询
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_STUB_DNS_RESOLVER_INC
+#define MINI_SOCKET_STUB_DNS_RESOLVER_INC
+
+#include "DNSResolver.hpp"
+
+#if defined (__linux__)
+#include <memory>
+#include <vector>
+#include "SocketAddress.hpp"
+
+namespace mini_socket {
+
+/**
+ * @brief DNS存根解析器
+ *
+ * 与DNSResolver返回相同的ResultRange, 但不经过getaddrinfo:
+ * - /etc/resolv.conf只在第一次使用时读取一次
+ * - A和AAAA查询在同一个UDPSocket上连续发出, 然后一起等待应答
+ * - 应答被截断(TC)时改用TCP重新查询
+ * - 应答在接收缓冲区中原地解析, 解析过程不分配内存; TCP应答的64KB缓冲区在第一次使用时分配, 之后重复使用
+ * - 只接受属于查询名字及其CNAME链的地址记录
+ *
+ * @note 不读取/etc/hosts, 不使用search域; 数字地址和localhost直接返回
+ * @note 一个解析器对象不能被多个线程同时使用, 每个线程使用自己的解析器
+ */
+class StubDNSResolver {
+public:
+    /**
+     * @brief 解析器配置
+     */
+    struct Config {
+        std::vector<SocketAddress> nameservers; // 域名服务器地址(含端口)
+        int timeoutMs = 5000;                   // 每次查询等待应答的时间
+        int attempts = 2;                       // 轮询全部服务器的次数
+    };
+
+    /**
+     * @brief 使用/etc/resolv.conf中的配置创建解析器
+     */
+    StubDNSResolver();
+
+    /**
+     * @brief 使用指定的配置创建解析器
+     *
+     * @param config 解析器配置, 没有域名服务器时使用127.0.0.1:53
+     */
+    explicit StubDNSResolver(const Config &config);
+
+    /**
+     * @brief 读取resolv.conf格式的配置文件
+     *
+     * @param path 配置文件路径
+     *
+     * @return 解析器配置; 文件不存在时返回默认配置
+     *
+     * @note 识别nameserver行和options中的timeout:n, attempts:n
+     */
+    static Config loadConfig(const char *path = "/etc/resolv.conf");
+
+    /**
+     * @brief DNS解析请求, 可以指定host, service和传输层协议类型
+     *
+     * @param host 被解析的主机名
+     * @param serv 被解析的服务名(端口号或/etc/services中的名字)
+     * @param trans_type 传输层协议类型: TCP or UDP
+     *
+     * @return 解析结果迭代器, IPv4地址在前
+     *
+     * @note 解析失败时抛出GAIException异常
+     */
+    DNSResolver::ResultRange query(const char *host, const char *serv, TransportLayerType trans_type);
+
+    /**
+     * @brief DNS解析请求, 可以指定host, service, 网络层协议类型和传输层协议类型
+     *
+     * @param host 被解析的主机名
+     * @param serv 被解析的服务名(端口号或/etc/services中的名字)
+     * @param net_type 网络层协议类型: IPv4只查询A记录, IPv6只查询AAAA记录
+     * @param trans_type 传输层协议类型: TCP or UDP
+     *
+     * @return 解析结果迭代器
+     *
+     * @note 解析失败时抛出GAIException异常
+     */
+    DNSResolver::ResultRange query(const char *host, const char *serv, NetworkLayerType net_type, TransportLayerType trans_type);
+
+private:
+    DNSResolver::ResultRange query(const char *host, const char *serv, int family, int socktype);
+
+    std::shared_ptr<const Config> config_;
+    std::unique_ptr<unsigned char[]> tcpBuffer_;    // TCP应答的接收缓冲区
+};
+
+}   // mini_socket
+#endif
+
+#endif
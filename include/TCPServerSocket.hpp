@@ -43,6 +43,29 @@ public:
      * @return 已连接的TCPSocket对象
      */
     std::shared_ptr<TCPSocket> accept();
+
+    /**
+     * @brief 从已完成连接队列返回一下个已连接socket, 同时返回对端地址
+     *
+     * @param[out] peerAddress 对端地址
+     *
+     * @return 已连接的TCPSocket对象
+     */
+    std::shared_ptr<TCPSocket> accept(SocketAddress &peerAddress);
+
+    /**
+     * @brief 设置accept时的对端地址过滤器
+     *
+     * 被拒绝的连接在accept后立即关闭, 不会创建TCPSocket对象, accept继续等待下一个连接.
+     *
+     * @param filter 过滤器, 为空表示不过滤
+     */
+    void setAcceptFilter(PeerFilter filter);
+
+private:
+    SOCKET acceptFiltered(sockaddr_storage &addr, socklen_t &addrLen);
+
+    PeerFilter acceptFilter_;   // 对端地址过滤器
 };
 
 }   // mini_socket
@@ -29,15 +29,39 @@ public:
      */
     TCPSocket(const SocketAddress &foreignAddress); 
 
+#if defined (__linux__)
     /**
-     * @brief 发送所有数据
+     * @brief 开启发送时间戳上报, 并同时开启接收时间戳
      *
-     * @param buffer 要发送数据的内容
+     * @param hardware 是否同时请求网卡硬件时间戳, 开启后sendSampled也请求硬件发送时间戳
+     *
+     * @note 必须在连接建立后调用; 字节序号从调用时刻开始计数(SOF_TIMESTAMPING_OPT_ID),
+     *       只有通过sendSampled发送的数据才会产生发送时间戳
+     */
+    void enableTxTimestamping(bool hardware = false);
+
+    /**
+     * @brief 发送数据, 并对本次发送的最后一个字节采样发送时间戳
+     *
+     * @param buffer 要发送的数据内容
      * @param bufferLen 数据长度
      *
-     * @note 可能会抛出SocketException异常
+     * @return 返回发送出的数据长度
+     *
+     * @note 时间戳(入队, 发出, 被确认)稍后通过recvTxTimestamp读取,
+     *       其id为该字节自enableTxTimestamping以来的序号
      */
-    void sendAll(const char *buffer, int bufferLen); 
+    int sendSampled(const char *buffer, int bufferLen); 
+
+    /**
+     * @brief 从错误队列读取一个发送时间戳, 不阻塞
+     *
+     * @param[out] ts 发送时间戳
+     *
+     * @return 如果读到时间戳返回true; 队列为空返回false
+     */
+    bool recvTxTimestamp(SocketTimestamp &ts);
+#endif
 
     /**
      * @brief 获取当前socket的iostream子类
@@ -52,6 +76,7 @@ private:
 
     std::iostream *myStream_ = 0;
     std::streambuf *myStreambuf_ = 0;
+    bool txHardware_ = false;       // sendSampled是否同时请求网卡发送时间戳
 };
 
 }   // mini_socket
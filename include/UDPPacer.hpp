@@ -0,0 +1,87 @@
+/**
+ * @file UDPPacer.hpp
+ * @brief 按固定速率发送UDP报文的限速器
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ */
+#ifndef MINI_SOCKET_UDP_PACER_INC
+#define MINI_SOCKET_UDP_PACER_INC
+
+#include "UDPSocket.hpp"
+
+#if defined (__linux__)
+namespace mini_socket {
+
+/**
+ * @brief 按固定速率发送UDP报文的限速器
+ *
+ * 每个报文都计算一个发送时间, 交给UDPSocket的带发送时间的sendTo:
+ * 开启SO_TXTIME时由内核(fq qdisc)按时发送, 否则在用户态等待.
+ * 报文在时间轴上均匀分布, 不会整批突发.
+ */
+class UDPPacer {
+public:
+    /**
+     * @brief 创建一个限速器
+     *
+     * @param sock 用于发送的UDPSocket, 限速器不管理其生命周期
+     */
+    UDPPacer(UDPSocket &sock);
+
+    /**
+     * @brief 设置报文速率
+     *
+     * @param packetsPerSecond 每秒报文数, 0表示不限制
+     */
+    void setPacketRate(double packetsPerSecond);
+
+    /**
+     * @brief 设置比特速率(按UDP载荷计算)
+     *
+     * @param bitsPerSecond 每秒比特数, 0表示不限制
+     *
+     * @note 同时设置了报文速率时, 取两者中更慢的一个
+     */
+    void setBitRate(double bitsPerSecond);
+
+    /**
+     * @brief 设置发送时间最多可以领先当前时间多少
+     *
+     * @param nanoseconds 领先的纳秒数, 默认1ms
+     *
+     * @note 超过后sendTo会阻塞, 避免内核队列里积压过多未到时间的报文
+     */
+    void setMaxLead(int64_t nanoseconds);
+
+    /**
+     * @brief 按速率向指定socket地址发送数据
+     *
+     * @param buffer 要发送的数据内容
+     * @param bufferLen 数据长度
+     * @param foreignAddress 远端地址
+     *
+     * @return 已发送数据长度
+     */
+    int sendTo(const char *buffer, int bufferLen,
+            const SocketAddress &foreignAddress);
+
+    /**
+     * @brief 获取当前时间
+     *
+     * @return CLOCK_MONOTONIC的纳秒数
+     */
+    static int64_t now();
+
+private:
+    UDPSocket &sock_;
+    double nsPerPacket_ = 0;    // 每个报文的间隔
+    double nsPerByte_ = 0;      // 每个字节的间隔
+    double next_ = 0;           // 下一个报文的发送时间
+    int64_t maxLead_ = 1000000;
+};
+
+}   // mini_socket
+#endif
+
+#endif
@@ -9,9 +9,12 @@
 #define MINI_SOCKET_UDP_SOCKET_INC
 
 #include "Socket.hpp"
+#include "SocketTimestamp.hpp"
 
 namespace mini_socket {
 
+class DatagramBuffer;
+
 /**
  * @brief 用户报文Socket
  */
@@ -49,6 +52,110 @@ public:
      */
     int recvFrom(char *buffer, int bufferLen,
             SocketAddress &sourceAddress); 
+
+    /**
+     * @brief 接收数据到报文缓存池中的缓存, 同时记录长度和发送端地址
+     *
+     * @param buffer 从DatagramBufferPool获取的缓存
+     *
+     * @return 接收数据长度
+     */
+    int recvFrom(DatagramBuffer &buffer); 
+
+    /**
+     * @brief 设置接收报文时的源地址过滤器
+     *
+     * 被拒绝的报文直接丢弃, recvFrom继续接收下一个报文; recvBatch把同一批中
+     * 被拒绝的报文去掉, 一批全部被拒绝时继续接收下一批.
+     *
+     * @param filter 过滤器, 为空表示不过滤
+     */
+    void setReceiveFilter(PeerFilter filter);
+
+#if defined (__linux__)
+    /**
+     * @brief 接收数据, 同时返回内核接收该报文的时间戳
+     *
+     * @param buffer 接收数据缓存地址
+     * @param bufferLen 缓存长度
+     * @param sourceAddress 发送端地址
+     * @param[out] ts 内核接收时间戳, 需要先调用enableTimestamping
+     *
+     * @return 接收数据长度
+     */
+    int recvFrom(char *buffer, int bufferLen,
+            SocketAddress &sourceAddress, SocketTimestamp &ts); 
+
+    /**
+     * @brief 开启SO_TXTIME, 由内核按指定的发送时间调度报文(earliest departure time)
+     *
+     * @return 如果内核支持返回true; 否则返回false, 带发送时间的sendTo会在用户态等待到发送时间
+     *
+     * @note 发送时间基于CLOCK_MONOTONIC, 出口网卡需要配置fq qdisc才能真正按时发送
+     */
+    bool enableTxTime();
+
+    /**
+     * @brief 在指定时间向指定socket地址发送数据
+     *
+     * @param buffer 要发送的数据内容
+     * @param bufferLen 数据长度
+     * @param foreignAddress 远端地址
+     * @param departureTime 发送时间, CLOCK_MONOTONIC的纳秒数
+     *
+     * @return 已发送数据长度
+     *
+     * @note 如果没有开启SO_TXTIME, 会阻塞到departureTime再发送
+     */
+    int sendTo(const char *buffer, int bufferLen,
+            const SocketAddress &foreignAddress, int64_t departureTime);
+
+    /**
+     * @brief 一次系统调用(sendmmsg)向指定socket地址发送多个报文
+     *
+     * @param buffer 连续存放的报文, 第i个报文位于buffer + i * datagramLen
+     * @param datagramLen 每个报文的长度
+     * @param count 报文个数, 一次最多MAX_BATCH个
+     * @param foreignAddress 远端地址
+     *
+     * @return 实际发送的报文个数
+     */
+    int sendBatch(const char *buffer, int datagramLen, int count,
+            const SocketAddress &foreignAddress);
+
+    /**
+     * @brief 使用UDP GSO发送, 内核把buffer按segmentSize切分成多个报文
+     *
+     * @param buffer 要发送的数据内容
+     * @param bufferLen 数据长度, 不超过64KB
+     * @param segmentSize 每个报文的长度, 最后一个报文可以更短
+     * @param foreignAddress 远端地址
+     *
+     * @return 已发送数据长度
+     */
+    int sendSegmented(const char *buffer, int bufferLen, int segmentSize,
+            const SocketAddress &foreignAddress);
+
+    /**
+     * @brief 一次系统调用(recvmmsg)接收多个报文
+     *
+     * @param buffer 接收缓存, 第i个报文存放在buffer + i * datagramLen
+     * @param datagramLen 每个报文的最大长度
+     * @param count 最多接收的报文个数, 一次最多MAX_BATCH个
+     * @param[out] lens 返回每个报文的长度
+     * @param[out] ts 如果不为NULL, 返回每个报文的内核接收时间戳
+     *
+     * @return 实际接收的报文个数, 至少1个; 设置了源地址过滤器时不包括被拒绝的报文
+     */
+    int recvBatch(char *buffer, int datagramLen, int count, int *lens,
+            SocketTimestamp *ts = NULL);
+
+    static const int MAX_BATCH = 64;    // sendBatch/recvBatch单次最多处理的报文个数
+#endif
+
+private:
+    PeerFilter receiveFilter_;      // 源地址过滤器
+    bool txTimeEnabled_ = false;    // 是否由内核调度发送时间
 };
 
 }   // mini_socket
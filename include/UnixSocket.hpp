@@ -0,0 +1,266 @@
+/**
+ * @file UnixSocket.hpp
+ * @brief Unix域socket: 面向连接(流/有序报文)和数据报两种
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @see UNIX Network Programming Volume 1: The Sockets Networking API, Third Edition, Chapter 15
+ */
+#ifndef MINI_SOCKET_UNIX_SOCKET_INC
+#define MINI_SOCKET_UNIX_SOCKET_INC
+
+#if !defined (WIN32) && !defined (_WIN32)
+
+#include <memory>
+#include "Socket.hpp"
+#include "CommunicatingSocket.hpp"
+
+namespace mini_socket {
+
+/**
+ * @brief 创建文件系统路径形式的Unix域socket地址
+ *
+ * @param path socket文件路径
+ *
+ * @return socket地址
+ *
+ * @note 路径超过sun_path的长度时抛出SYSException异常
+ */
+SocketAddress make_unix_address(const char *path);
+
+#if defined (__linux__)
+/**
+ * @brief 创建抽象名字空间的Unix域socket地址(Linux), 不在文件系统中创建文件
+ *
+ * @param name 名字, 不包含开头的'\0'
+ *
+ * @return socket地址, 打印时显示为"@name"
+ *
+ * @note 名字超过sun_path的长度时抛出SYSException异常
+ */
+SocketAddress make_abstract_unix_address(const char *name);
+#endif
+
+/// 一个报文中最多可以传递的描述符个数(sendFds/recvFds)
+const int MAX_PASS_FDS = 16;
+
+/// Unix域面向连接socket的类型
+enum class UnixSocketType {
+    STREAM = SOCK_STREAM,           /**< 字节流, 与TCP的语义相同 */
+    SEQPACKET = SOCK_SEQPACKET,     /**< 有序, 可靠, 保留报文边界 */
+};
+
+/**
+ * @brief Unix域的面向连接socket, 字节流或有序报文(SOCK_SEQPACKET)
+ *
+ * 继承自CommunicatingSocket, 基于CommunicatingSocket编写的处理函数(如str_echo)
+ * 可以不加修改地用于TCP和Unix域socket.
+ */
+class UnixStreamSocket : public CommunicatingSocket {
+public:
+    UnixStreamSocket() = default;
+
+    /**
+     * @brief 创建一个Unix域socket, 并connect到服务器端地址
+     *
+     * @param foreignAddress 服务器端地址, 见make_unix_address
+     * @param type socket类型
+     *
+     * @note 可能会抛出SocketException异常
+     */
+    UnixStreamSocket(const SocketAddress &foreignAddress, UnixSocketType type = UnixSocketType::STREAM);
+
+    /**
+     * @brief 创建一对互相连接的socket(socketpair)
+     *
+     * @param[out] first 第一个socket
+     * @param[out] second 第二个socket
+     * @param type socket类型
+     */
+    static void pair(UnixStreamSocket &first, UnixStreamSocket &second,
+            UnixSocketType type = UnixSocketType::STREAM);
+
+    /**
+     * @brief 发送数据, 同时把描述符传递给对端进程(SCM_RIGHTS)
+     *
+     * @param buffer 要发送的数据内容, 至少1字节
+     * @param bufferLen 数据长度
+     * @param fds 要传递的描述符, 发送后本进程中的描述符仍然有效
+     * @param numFds 描述符个数, 不超过MAX_PASS_FDS
+     *
+     * @return 已发送数据长度; 字节流socket上可能小于bufferLen, 此时描述符已经随第一个字节发出
+     */
+    int sendFds(const char *buffer, int bufferLen, const SOCKET *fds, int numFds);
+
+    /**
+     * @brief 接收数据, 以及随数据传递过来的描述符
+     *
+     * @param buffer 接收数据缓存地址
+     * @param bufferLen 缓存长度
+     * @param[out] fds 接收到的描述符, 由调用者负责关闭
+     * @param[in,out] numFds 输入fds的容量, 输出接收到的描述符个数
+     *
+     * @return 接收数据长度, 0表示对端已关闭
+     *
+     * @note 对端传递的描述符多于numFds时, 关闭已收到的描述符并抛出SYSException(EMSGSIZE)
+     */
+    int recvFds(char *buffer, int bufferLen, SOCKET *fds, int &numFds);
+
+    /**
+     * @brief 把一个socket(如TCPServerSocket::accept返回的连接)移交给对端进程
+     *
+     * @param sock 要移交的socket, 发送成功后在本进程中关闭(不会shutdown连接)
+     * @param buffer 随socket发送的数据, 至少1字节
+     * @param bufferLen 数据长度
+     *
+     * @return 已发送数据长度
+     */
+    int sendSocket(Socket &sock, const char *buffer, int bufferLen);
+
+    /**
+     * @brief 接收对端进程移交过来的socket, 并构造成SocketType对象
+     *
+     * @code
+     * int n;
+     * char buf[64];
+     * while (auto conn = channel.recvSocket<TCPSocket>(buf, sizeof(buf), n))
+     *     str_echo(*conn);
+     * @endcode
+     *
+     * @tparam SocketType socket类型, 如TCPSocket, UDPSocket, 需要与发送的socket一致
+     * @param buffer 接收数据缓存地址
+     * @param bufferLen 缓存长度
+     * @param[out] received 接收数据长度, 0表示对端已关闭
+     *
+     * @return 接收到的socket; 对端已关闭或报文中没有描述符时返回空指针
+     */
+    template <typename SocketType>
+    std::shared_ptr<SocketType> recvSocket(char *buffer, int bufferLen, int &received);
+
+private:
+    friend class UnixServerSocket;
+    UnixStreamSocket(SOCKET sockDesc);
+};
+
+/**
+ * @brief Unix域面向连接socket的Server端
+ */
+class UnixServerSocket : public Socket {
+public:
+    UnixServerSocket() = default;
+
+    /**
+     * @brief 创建一个Unix域socket的Server端, 绑定本地地址, 并监听
+     *
+     * @param localAddress 本地地址, 见make_unix_address
+     * @param type socket类型
+     *
+     * @note 如果路径上已有socket文件, 并且没有进程在监听(connect返回ECONNREFUSED),
+     *       会先删除它; 关闭后socket文件仍然保留
+     */
+    UnixServerSocket(const SocketAddress &localAddress, UnixSocketType type = UnixSocketType::STREAM);
+
+    /**
+     * @brief 设置排队队列长度
+     *
+     * @param backlog 排队队列长度
+     */
+    void listen(int backlog);
+
+    /**
+     * @brief 从已完成连接队列返回一下个已连接socket
+     *
+     * @return 已连接的UnixStreamSocket对象
+     */
+    std::shared_ptr<UnixStreamSocket> accept();
+};
+
+/**
+ * @brief Unix域数据报socket
+ *
+ * @note 对端要回复数据报时, 发送端必须先绑定一个地址
+ */
+class UnixDatagramSocket : public Socket {
+public:
+    UnixDatagramSocket() = default;
+
+    /**
+     * @brief 创建一个绑定本地地址的Unix域数据报socket
+     *
+     * @param localAddress 本地地址, 见make_unix_address
+     *
+     * @note 如果路径上已有没有被使用的socket文件, 会先删除它
+     */
+    UnixDatagramSocket(const SocketAddress &localAddress);
+
+    /**
+     * @brief 创建一对互相连接的数据报socket(socketpair)
+     *
+     * @param[out] first 第一个socket
+     * @param[out] second 第二个socket
+     */
+    static void pair(UnixDatagramSocket &first, UnixDatagramSocket &second);
+
+    /**
+     * @brief 向指定地址发送数据报
+     *
+     * @param buffer 要发送的数据内容
+     * @param bufferLen 数据长度
+     * @param foreignAddress 远端地址
+     *
+     * @return 已发送数据长度
+     */
+    int sendTo(const char *buffer, int bufferLen, const SocketAddress &foreignAddress);
+
+    /**
+     * @brief 接收数据报
+     *
+     * @param buffer 接收数据缓存地址
+     * @param bufferLen 缓存长度
+     * @param sourceAddress 发送端地址, 发送端没有绑定地址时为未命名地址
+     *
+     * @return 接收数据长度
+     */
+    int recvFrom(char *buffer, int bufferLen, SocketAddress &sourceAddress);
+
+    /**
+     * @brief 向已连接的对端(pair创建的socket)发送数据报
+     */
+    int send(const char *buffer, int bufferLen);
+
+    /**
+     * @brief 从已连接的对端(pair创建的socket)接收数据报
+     */
+    int recv(char *buffer, int bufferLen);
+
+    /**
+     * @brief 向已连接的对端发送数据报, 同时传递描述符, 见UnixStreamSocket::sendFds
+     */
+    int sendFds(const char *buffer, int bufferLen, const SOCKET *fds, int numFds);
+
+    /**
+     * @brief 从已连接的对端接收数据报和描述符, 见UnixStreamSocket::recvFds
+     */
+    int recvFds(char *buffer, int bufferLen, SOCKET *fds, int &numFds);
+};
+
+template <typename SocketType>
+std::shared_ptr<SocketType> UnixStreamSocket::recvSocket(char *buffer, int bufferLen, int &received)
+{
+    SOCKET sockDesc;
+    int numFds = 1;
+    received = recvFds(buffer, bufferLen, &sockDesc, numFds);
+    if (numFds == 0)
+        return std::shared_ptr<SocketType>();
+
+    std::shared_ptr<SocketType> sock(new SocketType());
+    sock->assign(sockDesc);
+    return sock;
+}
+
+}   // mini_socket
+
+#endif
+
+#endif
@@ -18,13 +18,28 @@
 #include "SocketCommon.hpp"
 #include "SocketAddress.hpp"
 #include "SocketAddressView.hpp"
+#include "CompactSocketAddress.hpp"
+#include "AddressLiteral.hpp"
+#include "PrefixTable.hpp"
+#include "SocketTimestamp.hpp"
 #include "Socket.hpp"
 #include "CommunicatingSocket.hpp"
 #include "TCPSocket.hpp"
 #include "TCPServerSocket.hpp"
 #include "UDPSocket.hpp"
+#include "UDPPacer.hpp"
+#include "DatagramBufferPool.hpp"
+#include "PacketSocket.hpp"
+#include "NetlinkSocket.hpp"
+#include "InterfaceTable.hpp"
+#include "SocketDiag.hpp"
 #include "UDPClientSocket.hpp"
+#include "UnixSocket.hpp"
+#include "ShmChannel.hpp"
 #include "DNSResolver.hpp"
+#include "DNSCache.hpp"
+#include "StubDNSResolver.hpp"
+#include "DNSBatchQuery.hpp"
 #include "tcp_connect.hpp"
 #include "udp_connect.hpp"
 
@@ -19,6 +19,25 @@ class TCPSocket;
 
 std::shared_ptr<TCPSocket> tcp_connect(const char *host, const char *serv);
 
+#if defined (__linux__)
+/**
+ * @brief Happy Eyeballs(RFC 8305)方式的tcp connect
+ *
+ * 解析结果按IPv6/IPv4交替排列, 每隔attemptDelayMs发起下一个非阻塞连接,
+ * 某个连接失败时立即发起下一个; 第一个建立的连接被返回, 其余的被关闭.
+ *
+ * @param host 主机名
+ * @param serv 服务名
+ * @param attemptDelayMs 相邻两次连接尝试的间隔, RFC 8305建议250毫秒
+ * @param timeoutMs 整体超时的毫秒数, -1表示不限制(仍受每个连接自身超时的约束)
+ *
+ * @return 已连接的TCPSocket(阻塞模式)
+ *
+ * @note 全部失败或超时时抛出SYSException异常
+ */
+std::shared_ptr<TCPSocket> tcp_connect(const char *host, const char *serv, int attemptDelayMs, int timeoutMs = -1);
+#endif
+
 }   // namespace mini_socket
 
 #endif
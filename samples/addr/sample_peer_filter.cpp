@@ -0,0 +1,87 @@
+/** \example addr/sample_peer_filter.cpp
+ * This is an example of how to filter TCP connections and UDP datagrams by peer address with a PrefixTable.
+ */
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include "mini_socket.hpp"
+
+using namespace std;
+using namespace mini_socket;
+
+enum { ALLOW = 1, DENY = 0 };
+
+// 127.0.0.2在Linux上不需要配置就可以使用, 其它系统上可能需要先添加这个环回地址
+const char *ALLOWED_IP = "127.0.0.1";
+const char *DENIED_IP = "127.0.0.2";
+
+int main()
+{
+    PrefixTable acl;
+    acl.insert("127.0.0.0/8", ALLOW);
+    acl.insert("127.0.0.2/32", DENY);
+    PeerFilter filter = [&acl](const SocketAddressView &peer) {
+        char buf[ADDRESS_PORT_STRLEN];
+        peer.format(buf, sizeof(buf));
+        bool allowed = acl.lookup(peer) == ALLOW;
+        cout << "  filter: " << buf << (allowed ? " allowed" : " denied") << endl;
+        return allowed;
+    };
+
+    try {
+        // TCP: 被拒绝的连接在accept内部关闭, accept返回下一个被允许的连接
+        cout << "tcp:" << endl;
+        TCPServerSocket server(SocketAddress("0.0.0.0", 0));
+        server.setAcceptFilter(filter);
+        SocketAddress serverAddr(ALLOWED_IP, get<1>(server.getLocalAddress().getAddressPort()));
+
+        TCPSocket denied;
+        denied.open(NetworkLayerType::IPv4, TransportLayerType::TCP);
+        denied.bind(SocketAddress(DENIED_IP, 0));
+        if (::connect(denied.getNativeHandle(), serverAddr.getSockaddr(), serverAddr.getSockaddrLen()) != 0) {
+            cout << "connect from " << DENIED_IP << " failed" << endl;
+            return 1;
+        }
+        TCPSocket allowed(serverAddr);
+
+        SocketAddress peer;
+        shared_ptr<TCPSocket> conn = server.accept(peer);
+        cout << "accepted " << peer.toString() << endl;
+        char c;
+        cout << "denied client recv: " << denied.recv(&c, 1) << " (closed by server)" << endl;
+
+        // UDP: 被拒绝的报文在recvFrom内部丢弃
+        cout << "udp:" << endl;
+        UDPSocket receiver(SocketAddress(ALLOWED_IP, 0));
+        receiver.setReceiveFilter(filter);
+        SocketAddress receiverAddr = receiver.getLocalAddress();
+
+        UDPSocket deniedSender(SocketAddress(DENIED_IP, 0));
+        UDPSocket allowedSender(SocketAddress(ALLOWED_IP, 0));
+        deniedSender.sendTo("from denied", strlen("from denied"), receiverAddr);
+        allowedSender.sendTo("from allowed", strlen("from allowed"), receiverAddr);
+
+        char buf[64];
+        int n = receiver.recvFrom(buf, sizeof(buf), peer);
+        cout << "received \"" << string(buf, n) << "\" from " << peer.toString() << endl;
+
+#if defined (__linux__)
+        // recvBatch同样过滤, 被拒绝的报文从这一批中去掉
+        const int DGLEN = 64;
+        char batch[4 * DGLEN];
+        int lens[4];
+        deniedSender.sendTo("denied 1", strlen("denied 1"), receiverAddr);
+        allowedSender.sendTo("allowed 1", strlen("allowed 1"), receiverAddr);
+        deniedSender.sendTo("denied 2", strlen("denied 2"), receiverAddr);
+        allowedSender.sendTo("allowed 2", strlen("allowed 2"), receiverAddr);
+        int count = receiver.recvBatch(batch, DGLEN, 4, lens);
+        for (int i = 0; i < count; i++)
+            cout << "batch received \"" << string(batch + i * DGLEN, lens[i]) << "\"" << endl;
+#endif
+    } catch (const SocketException &e) {
+        cout << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
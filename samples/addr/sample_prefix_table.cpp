@@ -0,0 +1,146 @@
+/** \example addr/sample_prefix_table.cpp
+ * This is an example of how to use the PrefixTable class, checked against a brute-force search.
+ */
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+#include "mini_socket.hpp"
+
+using namespace std;
+using namespace mini_socket;
+
+// 参照实现: 每种前缀长度一个精确匹配表, 查找时从最长的长度开始逐个尝试
+struct BruteForceTable {
+    int bytes;                                  // 地址长度, 4或16
+    vector<map<vector<uint8_t>, int>> byLen;    // byLen[len]: 按len清零后的地址 -> 值
+
+    explicit BruteForceTable(int bytes): bytes(bytes), byLen(bytes * 8 + 1) {}
+
+    static vector<uint8_t> mask(const uint8_t *addr, int bytes, int len)
+    {
+        vector<uint8_t> masked(addr, addr + bytes);
+        for (int i = 0; i < bytes; i++) {
+            int bits = len - i * 8;
+            if (bits <= 0)
+                masked[i] = 0;
+            else if (bits < 8)
+                masked[i] &= (uint8_t) (0xff << (8 - bits));
+        }
+        return masked;
+    }
+
+    void insert(const uint8_t *addr, int len, int value)
+    {
+        byLen[len][mask(addr, bytes, len)] = value;
+    }
+
+    int lookup(const uint8_t *addr) const
+    {
+        for (int len = bytes * 8; len >= 0; len--) {
+            if (byLen[len].empty())
+                continue;
+            auto it = byLen[len].find(mask(addr, bytes, len));
+            if (it != byLen[len].end())
+                return it->second;
+        }
+        return PrefixTable::NO_MATCH;
+    }
+};
+
+static void make_sockaddr(int family, const uint8_t *addr, sockaddr_storage &ss)
+{
+    memset(&ss, 0, sizeof(ss));
+    if (family == AF_INET) {
+        sockaddr_in *sin = (sockaddr_in *) &ss;
+        sin->sin_family = AF_INET;
+        memcpy(&sin->sin_addr, addr, 4);
+    } else {
+        sockaddr_in6 *sin6 = (sockaddr_in6 *) &ss;
+        sin6->sin6_family = AF_INET6;
+        memcpy(&sin6->sin6_addr, addr, 16);
+    }
+}
+
+// 随机插入前缀, 再随机查找, 和参照实现的结果对照; 返回不一致的次数
+static int check(int family, int prefixCount, int lookupCount, mt19937 &rng)
+{
+    int bytes = family == AF_INET ? 4 : 16;
+    int maxLen = bytes * 8;
+    PrefixTable table;
+    BruteForceTable reference(bytes);
+
+    // 前缀从少数几个基址派生, 让它们互相嵌套和重叠
+    vector<vector<uint8_t>> bases(8, vector<uint8_t>(bytes));
+    for (auto &base: bases) {
+        for (auto &b: base)
+            b = (uint8_t) rng();
+    }
+
+    vector<vector<uint8_t>> inserted;
+    for (int i = 0; i < prefixCount; i++) {
+        vector<uint8_t> addr = bases[rng() % bases.size()];
+        int len = maxLen / 4 + rng() % (maxLen * 3 / 4 + 1);   // 太短的前缀会覆盖所有地址
+        for (int k = len / 8; k < bytes; k++)
+            addr[k] ^= (uint8_t) rng();     // 在基址上改动前缀长度附近及之后的位
+
+        sockaddr_storage ss;
+        make_sockaddr(family, addr.data(), ss);
+        table.insert((sockaddr *) &ss, len, i);
+        reference.insert(addr.data(), len, i);
+        inserted.push_back(addr);
+    }
+
+    int mismatches = 0, matched = 0;
+    for (int i = 0; i < lookupCount; i++) {
+        // 一半查找在已插入的前缀附近, 一半完全随机
+        vector<uint8_t> addr(bytes);
+        if (i % 2 == 0) {
+            addr = inserted[rng() % inserted.size()];
+            addr[bytes - 1 - rng() % 2] ^= (uint8_t) rng();
+        } else {
+            for (auto &b: addr)
+                b = (uint8_t) rng();
+        }
+
+        sockaddr_storage ss;
+        make_sockaddr(family, addr.data(), ss);
+        int got = table.lookup((sockaddr *) &ss);
+        int expected = reference.lookup(addr.data());
+        matched += expected != PrefixTable::NO_MATCH;
+        if (got != expected && mismatches++ < 10) {
+            char text[INET6_ADDRSTRLEN];
+            inet_ntop(family, addr.data(), text, sizeof(text));
+            cout << "mismatch: " << text << " got " << got << " expected " << expected << endl;
+        }
+    }
+    cout << (family == AF_INET ? "ipv4: " : "ipv6: ") << prefixCount << " prefixes, " << lookupCount
+        << " lookups, " << matched << " matched, " << mismatches << " mismatches" << endl;
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned seed = argc > 1 ? (unsigned) atoi(argv[1]) : 1;
+    mt19937 rng(seed);
+
+    int mismatches = 0;
+    mismatches += check(AF_INET, 2000, 20000, rng);
+    mismatches += check(AF_INET6, 2000, 20000, rng);
+
+    // IPv4映射的IPv6地址按IPv4地址查找
+    PrefixTable table;
+    table.insert("10.0.0.0/8", 1);
+    table.insert("10.1.2.0/24", 2);
+    table.insert("::/0", 3);
+    int mapped = table.lookup(SocketAddress("::ffff:10.1.2.3", 0));
+    if (mapped != 2) {
+        cout << "mismatch: ::ffff:10.1.2.3 got " << mapped << " expected 2" << endl;
+        mismatches++;
+    }
+
+    cout << "seed " << seed << ": " << (mismatches == 0 ? "ok" : "FAILED") << endl;
+    return mismatches == 0 ? 0 : 1;
+}
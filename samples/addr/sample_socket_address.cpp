@@ -8,6 +8,9 @@
 using namespace std;
 using namespace mini_socket;
 
+// 编译期解析并检查的地址
+constexpr CompactSocketAddress LOOPBACK = make_ipv4_address("127.0.0.1", 9999);
+
 int main(int argc, char *argv[])
 {
     if (argc != 3) {
@@ -18,5 +21,11 @@ int main(int argc, char *argv[])
     SocketAddress addr(argv[1], stoi(argv[2]));
     cout << addr.toString() << endl;
 
+    CompactSocketAddress compact(addr);
+    cout << compact << " (" << sizeof(compact) << " bytes, hash " << hex
+        << hash<CompactSocketAddress>()(compact) << dec << ")" << endl;
+    if (compact == LOOPBACK)
+        cout << "loopback" << endl;
+
     return 0;
 }
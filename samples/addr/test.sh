@@ -3,3 +3,6 @@
 ./sample_socket_address "299.0.0.1" 9999
 ./sample_socket_address "0000:0000:0000:0000:FFFF:FFFF:FFFF:FFFF" 9999
 ./sample_socket_address "1234:2346:0000:0000:0000:0000:0000:1111" 9999
+./sample_prefix_table 1
+./sample_prefix_table 2
+./sample_peer_filter
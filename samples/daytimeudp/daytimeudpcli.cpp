@@ -27,7 +27,7 @@ main(int argc, char **argv)
     char            recvline[MAXLINE + 1];
     int             n;
 	n = sock.recvFrom(recvline, MAXLINE, srcAddr);
-    cout << "recv from " << srcAddr.toString() << endl;
+    cout << "recv from " << srcAddr << endl;
 	recvline[n] = '\0';	/* null terminate */
     cout << recvline << endl;
 
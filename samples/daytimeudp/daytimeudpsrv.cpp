@@ -37,7 +37,7 @@ main(int argc, char **argv)
     time_t          ticks;
 	for ( ; ; ) {
         server.recvFrom(buff, MAXLINE, cliAddr);
-        cout << "datagram from " << cliAddr.toString() << endl;
+        cout << "datagram from " << cliAddr << endl;
 
 		ticks = time(NULL);
 		snprintf(buff, sizeof(buff), "%.24s\r\n", ctime(&ticks));
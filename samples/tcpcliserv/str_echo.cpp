@@ -1,5 +1,5 @@
 /** \example tcpcliserv/str_echo.cpp
- * The implement of str_echo function in tcp echo server.
+ * The implement of str_echo function in tcp (or unix domain) echo server.
  */
 #include "str_echo.hpp"
 
@@ -7,7 +7,7 @@ using namespace std;
 using namespace mini_socket;
 
 void
-str_echo(TCPSocket &sock)
+str_echo(CommunicatingSocket &sock)
 {
     const int   MAXLINE = 4096;
     char        buf[MAXLINE];
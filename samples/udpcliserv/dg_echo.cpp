@@ -17,7 +17,7 @@ dg_echo(UDPSocket &sock)
 
 	for ( ; ; ) {
 		n = sock.recvFrom(mesg, MAXLINE, cliaddr);
-        cout << "recvfrom " << cliaddr.toString() << endl;
+        cout << "recvfrom " << cliaddr << endl;
         sock.sendTo(mesg, n, cliaddr);
 	}
 }
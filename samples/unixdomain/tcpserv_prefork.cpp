@@ -0,0 +1,93 @@
+/** \example unixdomain/tcpserv_prefork.cpp
+ * This is an example of how to pass accepted TCP connections to prefork worker processes
+ * with UnixStreamSocket::sendSocket/recvSocket, instead of forking per connection.
+ */
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "mini_socket.hpp"
+#include "str_echo.hpp"
+
+using namespace std;
+using namespace mini_socket;
+
+static void worker_main(int id, UnixStreamSocket &channel);
+
+// fork之后只关闭本进程中的描述符: Socket::close会shutdown, 影响另一个进程中的同一个socket
+static void close_local(Socket &sock)
+{
+    ::close(sock.release());
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned short port = 9870;
+    int nworkers = 4;
+
+    if (argc == 2) {
+        port = stoi(argv[1]);
+    } else if (argc == 3) {
+        port = stoi(argv[1]);
+        nworkers = stoi(argv[2]);
+    } else {
+        cout << "usage: a.out <port> [ <#workers> ]" << endl;
+        exit(-1);
+    }
+
+    SocketAddress addr("0.0.0.0", port);
+    cout << "bind " << addr << endl;
+    TCPServerSocket server(addr);
+
+    // 每个worker一条有序报文通道, 每个报文携带一个连接和它的对端地址
+    vector<unique_ptr<UnixStreamSocket>> channels;
+    for (int i = 0; i < nworkers; i++) {
+        UnixStreamSocket parentEnd, childEnd;
+        UnixStreamSocket::pair(parentEnd, childEnd, UnixSocketType::SEQPACKET);
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            cout << "fork error" << endl;
+            exit(-1);
+        } else if (pid == 0) {      /* child process */
+            close_local(server);
+            close_local(parentEnd);
+            for (auto &channel: channels)
+                close_local(*channel);
+            worker_main(i, childEnd);
+            exit(0);
+        }
+
+        close_local(childEnd);
+        channels.emplace_back(new UnixStreamSocket);
+        channels.back()->assign(parentEnd.release());
+    }
+
+    char peer[ADDRESS_PORT_STRLEN];
+    for (size_t next = 0; ; next = (next + 1) % channels.size()) {
+        SocketAddress peerAddress;
+        auto sock = server.accept(peerAddress);
+        size_t len = peerAddress.format(peer, sizeof(peer));
+        channels[next]->sendSocket(*sock, peer, len + 1);   // 连同'\0'
+    }
+
+    return 0;
+}
+
+static void 
+worker_main(int id, UnixStreamSocket &channel)
+{
+    char peer[ADDRESS_PORT_STRLEN];
+    int n;
+    while (auto sock = channel.recvSocket<TCPSocket>(peer, sizeof(peer), n)) {
+        cout << "worker " << id << " (pid " << getpid() << "): " << peer << endl;
+        try {
+            str_echo(*sock);
+        } catch (const runtime_error &e) {
+            cout << "str_echo error, " << e.what() << endl;
+        }
+    }
+}
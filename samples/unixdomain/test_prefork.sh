@@ -0,0 +1,17 @@
+#!/usr/bin/env bash
+
+SRV_PORT=$(($RANDOM + 1024))
+./tcpserv_prefork $SRV_PORT 2 &
+SRV_PID=$!
+
+sleep 1
+
+for i in 1 2 3; do
+../tcpcliserv/tcpcli 127.0.0.1 $SRV_PORT <<EOF2
+hello $i
+bye $i
+EOF2
+done
+
+pkill -P $SRV_PID
+kill $SRV_PID
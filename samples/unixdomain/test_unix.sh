@@ -0,0 +1,31 @@
+#!/usr/bin/env bash
+
+SRV_PATH=/tmp/unixstr.$$
+./unixstrserv $SRV_PATH &
+SRV_PID=$!
+
+sleep 1
+
+./unixstrcli $SRV_PATH <<EOF2
+hello
+world
+bye
+EOF2
+
+kill $SRV_PID
+rm -f $SRV_PATH
+
+./unixstrserv -shm $SRV_PATH &
+SRV_PID=$!
+
+sleep 1
+
+./unixstrcli -shm $SRV_PATH <<EOF2
+hello
+shared memory
+EOF2
+
+kill $SRV_PID
+rm -f $SRV_PATH
+
+./unixdgpair
@@ -0,0 +1,47 @@
+/** \example unixdomain/unixdgpair.cpp
+ * This is an example of how to use the UnixDatagramSocket and UnixStreamSocket classes with socketpair.
+ */
+#include <string>
+#include <iostream>
+#include <cstring>
+#include <thread>
+#include "mini_socket.hpp"
+
+using namespace std;
+using namespace mini_socket;
+
+int main()
+{
+    // 数据报: 每次recv返回一个完整的报文
+    UnixDatagramSocket dg1, dg2;
+    UnixDatagramSocket::pair(dg1, dg2);
+    dg1.send("hello", 5);
+    dg1.send("world", 5);
+
+    char buf[64];
+    for (int i = 0; i < 2; i++) {
+        int n = dg2.recv(buf, sizeof(buf));
+        cout << "datagram: " << string(buf, n) << endl;
+    }
+
+    // 有序报文: 面向连接, 同时保留报文边界
+    UnixStreamSocket sp1, sp2;
+    UnixStreamSocket::pair(sp1, sp2, UnixSocketType::SEQPACKET);
+    thread peer([&sp2] {
+            char buf[64];
+            int n;
+            while ((n = sp2.recv(buf, sizeof(buf))) > 0)
+                sp2.sendAll(buf, n);
+        });
+
+    const char *msgs[] = { "one", "two", "three" };
+    for (auto msg: msgs) {
+        sp1.sendAll(msg, strlen(msg));
+        int n = sp1.recv(buf, sizeof(buf));
+        cout << "seqpacket: " << string(buf, n) << endl;
+    }
+    sp1.close();
+    peer.join();
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/** \example unixdomain/unixstrcli.cpp
+ * This is an example of how to use the UnixStreamSocket class to implement unix domain echo client,
+ * or ShmChannel with -shm (linux only).
+ */
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include "mini_socket.hpp"
+
+using namespace std;
+using namespace mini_socket;
+
+int main(int argc, char *argv[])
+{
+    bool shm = false;
+    if (argc == 3 && string(argv[1]) == "-shm") {
+        shm = true;
+    } else if (argc != 2) {
+        cout << "usage: a.out [ -shm ] <pathname>" << endl;
+        exit(-1);
+    }
+
+    SocketAddress addr = make_unix_address(argv[argc-1]);
+    unique_ptr<CommunicatingSocket> conn;
+#if defined (__linux__)
+    if (shm)
+        conn.reset(new ShmChannel(addr));
+    else
+#endif
+        conn.reset(new UnixStreamSocket(addr));
+    CommunicatingSocket &sock = *conn;
+
+    const int MAXLINE = 4096;
+    char buf[MAXLINE];
+    string sendline, recvline;
+    while (getline(cin, sendline)) {
+        sendline += '\n';
+        sock.sendAll(sendline.c_str(), sendline.size());
+
+        recvline.clear();
+        while (recvline.empty() || recvline.back() != '\n') {
+            int n = sock.recv(buf, MAXLINE);
+            if (n == 0) {
+                cout << "str_cli: server terminated prematurely" << endl;
+                exit(-1);
+            }
+            recvline.append(buf, n);
+        }
+        cout << recvline;
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+/** \example unixdomain/unixstrserv.cpp
+ * This is an example of how to use the UnixServerSocket class to implement unix domain echo server,
+ * the same str_echo also runs over ShmChannel (-shm, linux only).
+ */
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <thread>
+#include "mini_socket.hpp"
+#include "str_echo.hpp"
+
+using namespace std;
+using namespace mini_socket;
+
+static void doit(shared_ptr<CommunicatingSocket> sock);
+
+int main(int argc, char *argv[])
+{
+    bool shm = false;
+    if (argc == 3 && string(argv[1]) == "-shm") {
+        shm = true;
+    } else if (argc != 2) {
+        cout << "usage: a.out [ -shm ] <pathname>" << endl;
+        exit(-1);
+    }
+
+    SocketAddress addr = make_unix_address(argv[argc-1]);
+    cout << "bind " << addr << endl;
+    UnixServerSocket server(addr);
+
+    for ( ; ; ) {
+        shared_ptr<CommunicatingSocket> sock;
+#if defined (__linux__)
+        if (shm)
+            sock = ShmChannel::accept(server);  // 数据通过共享内存传输
+        else
+#endif
+            sock = server.accept();
+        thread(doit, sock).detach();
+    }
+
+    return 0;
+}
+
+static void 
+doit(shared_ptr<CommunicatingSocket> sock)
+{
+    try {
+        str_echo(*sock);    // 与tcpserv是同一个函数
+    } catch (const runtime_error &e) {
+        cout << "str_echo error, " << e.what() << endl;
+    }
+}
@@ -0,0 +1,17 @@
+#include "AddressLiteral.hpp"
+#include "SYSException.hpp"
+
+#include <cerrno>
+
+namespace mini_socket {
+
+namespace detail {
+
+void address_literal_error(const char *message)
+{
+    sys_error(message, EINVAL);
+}
+
+}   // namespace detail
+
+}   // namespace mini_socket
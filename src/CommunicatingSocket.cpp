@@ -2,6 +2,10 @@
 #include "SYSException.hpp"
 #include "SocketAddressView.hpp"
 
+#if defined (__linux__)
+#include <sys/uio.h>
+#endif
+
 namespace mini_socket {
 
 // CommunicatingSocket 
@@ -49,6 +53,18 @@ int CommunicatingSocket::send(const char *buffer, int bufferLen)
     return n;
 }
 
+void CommunicatingSocket::sendAll(const char *buffer, int bufferLen)
+{
+	auto ptr = (const char *) buffer;
+	auto nleft = bufferLen;
+    int nwritten = 0;
+	while (nleft > 0) {
+		nwritten = send(ptr, nleft);
+		nleft -= nwritten;
+		ptr   += nwritten;
+	}
+}
+
 int CommunicatingSocket::recv(char *buffer, int bufferLen)
 {
     int n = ::recv(sockDesc_, buffer, bufferLen, 0); 
@@ -59,6 +75,31 @@ int CommunicatingSocket::recv(char *buffer, int bufferLen)
     return n;
 }
 
+#if defined (__linux__)
+int CommunicatingSocket::recv(char *buffer, int bufferLen, SocketTimestamp &ts)
+{
+    iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = bufferLen;
+
+    char control[256];
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    int n = ::recvmsg(sockDesc_, &msg, 0); 
+    if ( n < 0 ) {
+        sys_error("Receive failed (recvmsg())");
+    }
+
+    ts = SocketTimestamp();
+    get_socket_timestamp(&msg, ts);
+    return n;
+}
+#endif
+
 SocketAddress CommunicatingSocket::getForeignAddress() const
 {
     sockaddr_storage addr;
@@ -0,0 +1,127 @@
+#include "CompactSocketAddress.hpp"
+#include "SocketAddress.hpp"
+#include "SocketAddressView.hpp"
+
+#include <ostream>
+
+namespace mini_socket {
+
+using std::string;
+
+static_assert(sizeof(CompactSocketAddress) == 24, "CompactSocketAddress must not contain padding");
+
+CompactSocketAddress::CompactSocketAddress(const sockaddr *sa, socklen_t salen)
+{
+    assign(sa, salen);
+}
+
+CompactSocketAddress::CompactSocketAddress(const SocketAddress &addr)
+{
+    assign(addr.getSockaddr(), addr.getSockaddrLen());
+}
+
+CompactSocketAddress::CompactSocketAddress(const SocketAddressView &addr)
+{
+    assign(addr.getSockaddr(), addr.getSockaddrLen());
+}
+
+bool CompactSocketAddress::assign(const sockaddr *sa, socklen_t salen)
+{
+    *this = CompactSocketAddress();
+    if (sa == NULL)
+        return false;
+
+    switch (sa->sa_family) {
+    case AF_INET: {
+        if (salen < (socklen_t) sizeof(sockaddr_in))
+            return false;
+        const sockaddr_in *sin = (const sockaddr_in *) sa;
+        family_ = AF_INET;
+        memcpy(addr_, &sin->sin_addr, 4);
+        port_ = sin->sin_port;
+        return true;
+    }
+    case AF_INET6: {
+        if (salen < (socklen_t) sizeof(sockaddr_in6))
+            return false;
+        const sockaddr_in6 *sin6 = (const sockaddr_in6 *) sa;
+        family_ = AF_INET6;
+        memcpy(addr_, &sin6->sin6_addr, 16);
+        port_ = sin6->sin6_port;
+        scopeId_ = sin6->sin6_scope_id;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+socklen_t CompactSocketAddress::toSockaddr(sockaddr_storage *ss) const
+{
+    memset(ss, 0, sizeof(*ss));
+    switch (family_) {
+    case AF_INET: {
+        sockaddr_in *sin = (sockaddr_in *) ss;
+        sin->sin_family = AF_INET;
+        memcpy(&sin->sin_addr, addr_, 4);
+        sin->sin_port = port_;
+        return sizeof(sockaddr_in);
+    }
+    case AF_INET6: {
+        sockaddr_in6 *sin6 = (sockaddr_in6 *) ss;
+        sin6->sin6_family = AF_INET6;
+        memcpy(&sin6->sin6_addr, addr_, 16);
+        sin6->sin6_port = port_;
+        sin6->sin6_scope_id = scopeId_;
+        return sizeof(sockaddr_in6);
+    }
+    default:
+        return 0;
+    }
+}
+
+SocketAddress CompactSocketAddress::toSocketAddress() const
+{
+    sockaddr_storage ss;
+    socklen_t len = toSockaddr(&ss);
+    if (len == 0)
+        return SocketAddress();
+    return SocketAddress((sockaddr *) &ss, len);
+}
+
+NetworkLayerType CompactSocketAddress::getNetworkLayerType() const
+{
+    switch (family_) {
+    case AF_INET:
+        return NetworkLayerType::IPv4;
+    case AF_INET6:
+        return NetworkLayerType::IPv6;
+    default:
+        return NetworkLayerType::UNKNOWN;
+    }
+}
+
+size_t CompactSocketAddress::format(char *buf, size_t len) const
+{
+    sockaddr_storage ss;
+    socklen_t salen = toSockaddr(&ss);
+    if (salen == 0)
+        return 0;
+    return format_address_port((sockaddr *) &ss, salen, buf, len);
+}
+
+string CompactSocketAddress::toString() const
+{
+    char str[ADDRESS_PORT_STRLEN];
+    size_t n = format(str, sizeof(str));
+    return string(str, n);
+}
+
+std::ostream &operator <<(std::ostream &os, const CompactSocketAddress &addr)
+{
+    char str[ADDRESS_PORT_STRLEN];
+    size_t n = addr.format(str, sizeof(str));
+    return os.write(str, n);
+}
+
+}   // namespace mini_socket
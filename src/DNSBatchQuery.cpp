@@ -0,0 +1,167 @@
+#include "DNSBatchQuery.hpp"
+#include "GAIException.hpp"
+
+#if defined (__linux__)
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <signal.h>
+#include <unistd.h>
+
+namespace mini_socket {
+
+struct DNSBatchQuery::Request {
+    // Request总在unique_ptr中, 地址不变, gaicb里的指针在创建时设置一次即可
+    Request(DNSBatchQuery *owner, const char *host, const char *serv, const addrinfo *hints):
+        owner(owner), host(host != NULL ? host : ""), serv(serv != NULL ? serv : "")
+    {
+        cb.ar_name = this->host.empty() ? NULL : this->host.c_str();
+        cb.ar_service = this->serv.empty() ? NULL : this->serv.c_str();
+        cb.ar_request = hints;
+    }
+
+    DNSBatchQuery *owner;
+    gaicb cb = {};
+    std::string host;
+    std::string serv;
+    std::atomic<int> result{EAI_INPROGRESS};    // 完成时的错误码, 0表示成功
+    int cancelResult = 0;   // gai_cancel的返回值: EAI_CANCELED, EAI_NOTCANCELED或EAI_ALLDONE; 0表示未取消
+};
+
+DNSBatchQuery::DNSBatchQuery(TransportLayerType trans_type): hints_()
+{
+    hints_.ai_family = AF_UNSPEC;
+    hints_.ai_socktype = (int) trans_type;
+}
+
+DNSBatchQuery::~DNSBatchQuery()
+{
+    if (!submitted_)
+        return;
+
+    // gaicb在通知之前不能释放: 先取消, 被取消的查询不会再有通知;
+    // 取消不了(EAI_NOTCANCELED)或刚刚完成(EAI_ALLDONE)的查询等它的通知
+    cancel();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this]() { return finished_ == requests_.size(); });
+    }
+    for (auto &req: requests_) {
+        if (req->cb.ar_result != NULL)
+            freeaddrinfo(req->cb.ar_result);
+    }
+}
+
+size_t DNSBatchQuery::add(const char *host, const char *serv)
+{
+    requests_.push_back(std::unique_ptr<Request>(new Request(this, host, serv, &hints_)));
+    return requests_.size() - 1;
+}
+
+void DNSBatchQuery::submit(int eventFd)
+{
+    if (requests_.empty())
+        return;
+
+    eventFd_ = eventFd;
+    submitted_ = true;
+
+    // 每个查询单独提交, 完成时各自通知; glibc只在一组查询全部完成时才通知一次,
+    // 而且其中有查询被取消时不再通知
+    for (auto &req: requests_) {
+        sigevent sev = {};
+        sev.sigev_notify = SIGEV_THREAD;
+        sev.sigev_value.sival_ptr = req.get();
+        sev.sigev_notify_function = [](sigval sv) {
+            Request *req = (Request *) sv.sival_ptr;
+            req->owner->complete(*req, ::gai_error(&req->cb));
+        };
+
+        gaicb *list[1] = { &req->cb };
+        int n = getaddrinfo_a(GAI_NOWAIT, list, 1, &sev);
+        if (n != 0)
+            complete(*req, n);
+    }
+}
+
+void DNSBatchQuery::complete(Request &req, int error)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (req.result.load(std::memory_order_relaxed) != EAI_INPROGRESS)
+        return;
+
+    req.result.store(error, std::memory_order_release);
+    if (++finished_ == requests_.size()) {
+        if (eventFd_ >= 0) {
+            uint64_t one = 1;
+            while (write(eventFd_, &one, sizeof(one)) < 0 && errno == EINTR)
+                ;
+        }
+        cond_.notify_all();
+    }
+}
+
+bool DNSBatchQuery::wait(int timeoutMs)
+{
+    if (!submitted_)
+        return true;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto allDone = [this]() { return finished_ == requests_.size(); };
+        if (timeoutMs < 0) {
+            cond_.wait(lock, allDone);
+        } else if (!cond_.wait_for(lock, std::chrono::milliseconds(timeoutMs), allDone)) {
+            lock.unlock();
+            cancel();
+            return false;
+        }
+    }
+
+    for (auto &req: requests_) {
+        if (req->result.load(std::memory_order_acquire) == EAI_CANCELED)
+            return false;
+    }
+    return true;
+}
+
+void DNSBatchQuery::cancel()
+{
+    // 有的glibc(如2.36)中gai_cancel成功后gai_error仍然返回EAI_INPROGRESS,
+    // 所以以gai_cancel的返回值为准; 取消不了的查询只取消一次
+    for (auto &req: requests_) {
+        if (req->result.load(std::memory_order_acquire) != EAI_INPROGRESS || req->cancelResult != 0)
+            continue;
+        req->cancelResult = gai_cancel(&req->cb);
+        if (req->cancelResult == EAI_CANCELED)
+            complete(*req, EAI_CANCELED);
+    }
+}
+
+bool DNSBatchQuery::isDone(size_t index) const
+{
+    return requests_.at(index)->result.load(std::memory_order_acquire) != EAI_INPROGRESS;
+}
+
+SocketError DNSBatchQuery::getError(size_t index) const
+{
+    int n = requests_.at(index)->result.load(std::memory_order_acquire);
+    if (n == 0)
+        return SocketError();
+    return make_gai_error(n);
+}
+
+DNSResolver::ResultRange DNSBatchQuery::getResult(size_t index)
+{
+    Request &req = *requests_.at(index);
+    int n = req.result.load(std::memory_order_acquire);
+    if (n != 0) {
+        gai_error("Resolve DNS query failed (getaddrinfo_a())", n);
+    }
+
+    return DNSResolver::ResultRange(req.cb.ar_result);
+}
+
+}   // namespace mini_socket
+
+#endif
@@ -0,0 +1,183 @@
+#include "DNSCache.hpp"
+
+namespace mini_socket {
+
+using std::lock_guard;
+using std::mutex;
+
+// DNSCache::Key
+DNSCache::Key::Key(const char *host, const char *serv, int family, int socktype):
+    host(host != NULL ? host : ""), serv(serv != NULL ? serv : ""),
+    family(family), socktype(socktype)
+{
+}
+
+size_t DNSCache::KeyHash::operator ()(const Key &key) const
+{
+    size_t h = std::hash<std::string>()(key.host);
+    h ^= std::hash<std::string>()(key.serv) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= (size_t) ((key.family << 8) | key.socktype) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+// DNSCache
+DNSCache &DNSCache::instance()
+{
+    // 不销毁: 后台刷新线程和getaddrinfo_a的通知线程在进程退出时可能仍在使用
+    static DNSCache *cache = new DNSCache;
+    return *cache;
+}
+
+void DNSCache::setEnabled(bool on)
+{
+    enabled_.store(on, std::memory_order_relaxed);
+    if (!on)
+        clear();
+}
+
+void DNSCache::setTTL(int ttlMs)
+{
+    ttlMs_.store(ttlMs, std::memory_order_relaxed);
+}
+
+void DNSCache::setMaxStale(int maxStaleMs)
+{
+    maxStaleMs_.store(maxStaleMs > 0 ? maxStaleMs : 0, std::memory_order_relaxed);
+}
+
+void DNSCache::setNegativeTTL(int ttlMs)
+{
+    negativeTtlMs_.store(ttlMs > 0 ? ttlMs : 0, std::memory_order_relaxed);
+}
+
+void DNSCache::setMaxEntries(size_t maxEntries)
+{
+    size_t perShard = (maxEntries + SHARD_COUNT - 1) / SHARD_COUNT;
+    maxEntriesPerShard_.store(perShard > 0 ? perShard : 1, std::memory_order_relaxed);
+}
+
+DNSCache::Shard &DNSCache::shardOf(const Key &key)
+{
+    return shards_[KeyHash()(key) % SHARD_COUNT];
+}
+
+DNSCache::LookupStatus DNSCache::lookup(const Key &key, DNSResolver::ResultRange &result,
+        int &error, bool &needRefresh)
+{
+    needRefresh = false;
+    Shard &shard = shardOf(key);
+    lock_guard<mutex> lock(shard.mutex);
+
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end())
+        return MISS;
+
+    Entry &entry = it->second;
+    Clock::time_point now = Clock::now();
+    if (now >= entry.staleUntil) {
+        shard.lru.erase(entry.lru);
+        shard.entries.erase(it);
+        return MISS;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru);
+    if (entry.error != 0) {
+        error = entry.error;
+        return NEGATIVE;
+    }
+
+    result = entry.result;
+    if (now < entry.expires)
+        return FRESH;
+
+    if (!entry.refreshing) {
+        entry.refreshing = true;
+        needRefresh = true;
+    }
+    return STALE;
+}
+
+DNSCache::Entry &DNSCache::put(const Key &key, int ttlMs, int maxStaleMs)
+{
+    Clock::time_point expires = Clock::now() + std::chrono::milliseconds(ttlMs);
+    Clock::time_point staleUntil = expires + std::chrono::milliseconds(maxStaleMs);
+    size_t maxEntries = maxEntriesPerShard_.load(std::memory_order_relaxed);
+
+    // 调用者持有分片的锁
+    Shard &shard = shardOf(key);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        Entry &entry = it->second;
+        entry.expires = expires;
+        entry.staleUntil = staleUntil;
+        entry.refreshing = false;
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru);
+        return entry;
+    }
+
+    while (shard.entries.size() >= maxEntries && !shard.lru.empty()) {
+        shard.entries.erase(shard.lru.back());
+        shard.lru.pop_back();
+    }
+
+    shard.lru.push_front(key);
+    Entry &entry = shard.entries[key];
+    entry.expires = expires;
+    entry.staleUntil = staleUntil;
+    entry.lru = shard.lru.begin();
+    return entry;
+}
+
+void DNSCache::insert(const Key &key, const DNSResolver::ResultRange &result)
+{
+    Shard &shard = shardOf(key);
+    lock_guard<mutex> lock(shard.mutex);
+    Entry &entry = put(key, ttlMs_.load(std::memory_order_relaxed),
+            maxStaleMs_.load(std::memory_order_relaxed));
+    entry.result = result;
+    entry.error = 0;
+}
+
+bool DNSCache::insertNegative(const Key &key, int error)
+{
+    int ttlMs = negativeTtlMs_.load(std::memory_order_relaxed);
+    if (ttlMs <= 0)
+        return false;
+
+    Shard &shard = shardOf(key);
+    lock_guard<mutex> lock(shard.mutex);
+    Entry &entry = put(key, ttlMs, 0);
+    entry.result = DNSResolver::ResultRange();
+    entry.error = error;
+    return true;
+}
+
+void DNSCache::refreshFailed(const Key &key)
+{
+    Shard &shard = shardOf(key);
+    lock_guard<mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end())
+        it->second.refreshing = false;
+}
+
+void DNSCache::clear()
+{
+    for (auto &shard: shards_) {
+        lock_guard<mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.lru.clear();
+    }
+}
+
+size_t DNSCache::size() const
+{
+    size_t n = 0;
+    for (auto &shard: shards_) {
+        lock_guard<mutex> lock(shard.mutex);
+        n += shard.entries.size();
+    }
+    return n;
+}
+
+}   // namespace mini_socket
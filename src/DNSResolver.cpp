@@ -1,29 +1,394 @@
 #include "DNSResolver.hpp"
 #include "GAIException.hpp"
+#include "DNSCache.hpp"
 
-#ifndef NDEBUG
-#include <iostream>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined (__linux__)
+#include <signal.h>
 #endif
 
 namespace mini_socket {
 
-// DNSResolver 
-std::shared_ptr<addrinfo> DNSResolver::query(const char *host, const char *serv, addrinfo *hints)
+namespace {
+
+// 正在进行中的同步查询: 相同的查询只由第一个线程执行, 其他线程等待共享它的结果或错误
+class InflightTable {
+public:
+    typedef std::shared_future<DNSResolver::ResultRange> Flight;
+
+    // 返回true表示调用者是leader, 需要执行查询并调用complete
+    bool join(const DNSCache::Key &key, Flight &flight, std::promise<DNSResolver::ResultRange> &promise)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = flights_.find(key);
+        if (it != flights_.end()) {
+            flight = it->second;
+            return false;
+        }
+        flight = promise.get_future().share();
+        flights_.emplace(key, flight);
+        return true;
+    }
+
+    void complete(const DNSCache::Key &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flights_.erase(key);
+    }
+
+    static InflightTable &instance()
+    {
+        static InflightTable table;
+        return table;
+    }
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<DNSCache::Key, Flight, DNSCache::KeyHash> flights_;
+};
+
+// in-flight查询的leader: 不论正常返回还是抛出异常(包括bad_alloc), 都释放getaddrinfo的结果,
+// 结束promise并移除in-flight记录, 否则之后的相同查询会一直等待一个不会完成的promise
+class FlightLeader {
+public:
+    FlightLeader(InflightTable &inflight, const DNSCache::Key &key, std::promise<DNSResolver::ResultRange> &promise):
+        inflight_(inflight), key_(key), promise_(promise)
+    {
+    }
+
+    ~FlightLeader()
+    {
+        if (res != NULL)
+            freeaddrinfo(res);
+        if (!settled_) {
+            try {
+                promise_.set_exception(std::make_exception_ptr(
+                            std::runtime_error("Resolve DNS query failed (leader exited)")));
+            } catch (...) {
+            }
+        }
+        inflight_.complete(key_);
+    }
+
+    void succeed(const DNSResolver::ResultRange &result)
+    {
+        promise_.set_value(result);
+        settled_ = true;
+    }
+
+    void fail(std::exception_ptr error)
+    {
+        promise_.set_exception(error);
+        settled_ = true;
+    }
+
+    addrinfo *res = NULL;       // getaddrinfo的结果, 析构时释放
+
+private:
+    InflightTable &inflight_;
+    const DNSCache::Key &key_;
+    std::promise<DNSResolver::ResultRange> &promise_;
+    bool settled_ = false;
+};
+
+// 数字形式的端口号, serv为NULL时端口为0
+bool parse_numeric_port(const char *serv, uint16_t &port)
 {
-    addrinfo *res;
-    int n;
-    if ( (n = getaddrinfo(host, serv, hints, &res)) != 0) {
-        gai_error("Resolve DNS query failed (getaddrinfo())", n);
+    port = 0;
+    if (serv == NULL)
+        return true;
+    if (*serv == '\0')
+        return false;
+
+    unsigned int value = 0;
+    for (const char *p = serv; *p != '\0'; p++) {
+        if (*p < '0' || *p > '9')
+            return false;
+        value = value * 10 + (*p - '0');
+        if (value > 65535)
+            return false;
     }
+    port = (uint16_t) value;
+    return true;
+}
 
-    auto deleter = [](addrinfo *ptr) {
-#ifndef NDEBUG
-						std::cout << "freeaddrinfo called" << std::endl;
+// 数字形式的主机地址和端口直接构造结果, 不经过getaddrinfo
+bool resolve_numeric(const char *host, const char *serv, int family, DNSResolver::ResultRange &result)
+{
+    uint16_t port;
+    if (host == NULL || !parse_numeric_port(serv, port))
+        return false;
+
+    sockaddr_storage ss;
+    socklen_t salen;
+    if (parse_address(host, strlen(host), port, &ss, &salen) != ParseAddressResult::OK)
+        return false;   // 不是数字地址, 交给getaddrinfo处理
+    if (family != AF_UNSPEC && family != ss.ss_family)
+        return false;   // 地址族不匹配, 由getaddrinfo给出错误
+
+    result.push_back((sockaddr *) &ss, salen);
+    return true;
+}
+
+// 只缓存"主机名不存在"这类确定的失败, 临时错误(EAI_AGAIN等)不缓存
+bool is_negative_error(int error)
+{
+#ifdef EAI_NODATA
+    if (error == EAI_NODATA)
+        return true;
 #endif
-                        freeaddrinfo(ptr);
-                    };
+    return error == EAI_NONAME;
+}
+
+void cache_result(DNSCache &cache, const DNSCache::Key &key, int error, const DNSResolver::ResultRange &result)
+{
+    if (error == 0)
+        cache.insert(key, result);
+    else if (is_negative_error(error))
+        cache.insertNegative(key, error);
+}
+
+// 陈旧的缓存条目由一个常驻的后台线程依次重新解析, 期间其他调用者继续使用陈旧结果.
+// 同一个键在排队或解析中时不会重复加入, 线程数和队列长度都有上限.
+// 对象和线程都不销毁: 进程退出时线程可能还在getaddrinfo中, 与静态对象的析构无关
+class Refresher {
+public:
+    static Refresher &instance()
+    {
+        static Refresher *refresher = new Refresher;
+        return *refresher;
+    }
+
+    void schedule(const DNSCache::Key &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!keys_.insert(key).second)
+            return;
+
+        if (!started_) {
+            try {
+                std::thread(&Refresher::run, this).detach();
+                started_ = true;
+            } catch (const std::system_error &) {
+                keys_.erase(key);
+                DNSCache::instance().refreshFailed(key);
+                return;
+            }
+        }
+        queue_.push_back(key);
+        cond_.notify_one();
+    }
+
+private:
+    Refresher() = default;
+
+    void run()
+    {
+        for ( ; ; ) {
+            DNSCache::Key key;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this]() { return !queue_.empty(); });
+                key = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            refresh(key);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            keys_.erase(key);
+        }
+    }
+
+    static void refresh(const DNSCache::Key &key)
+    {
+        addrinfo hints = {};
+        hints.ai_family = key.family;
+        hints.ai_socktype = key.socktype;
+
+        DNSCache &cache = DNSCache::instance();
+        addrinfo *res;
+        int n = getaddrinfo(key.host.empty() ? NULL : key.host.c_str(),
+                key.serv.empty() ? NULL : key.serv.c_str(), &hints, &res);
+        if (n == 0) {
+            cache_result(cache, key, 0, DNSResolver::ResultRange(res));
+            freeaddrinfo(res);
+        } else if (!is_negative_error(n) || !cache.insertNegative(key, n)) {
+            // 没有写入新结果时条目仍处于刷新中, 必须清除标记, 否则以后不会再刷新
+            cache.refreshFailed(key);
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<DNSCache::Key> queue_;
+    std::unordered_set<DNSCache::Key, DNSCache::KeyHash> keys_;   // 排队或正在解析的键
+    bool started_ = false;
+};
+
+// 在缓存中查找, 命中(包括陈旧结果和缓存的失败)时返回true
+bool lookup_cache(DNSCache &cache, const DNSCache::Key &key, DNSResolver::ResultRange &result, int &error)
+{
+    bool needRefresh;
+    error = 0;
+    switch (cache.lookup(key, result, error, needRefresh)) {
+    case DNSCache::FRESH:
+    case DNSCache::NEGATIVE:
+        return true;
+    case DNSCache::STALE:
+        if (needRefresh)
+            Refresher::instance().schedule(key);
+        return true;
+    default:
+        return false;
+    }
+}
+
+}   // namespace
+
+// DNSResolver::ResultRange
+DNSResolver::ResultRange::ResultRange(const addrinfo *res)
+{
+    for ( ; res != NULL; res = res->ai_next)
+        push_back(res->ai_addr, res->ai_addrlen);
+}
+
+DNSResolver::ResultRange::ResultRange(const ResultRange &rhs)
+{
+    *this = rhs;
+}
+
+DNSResolver::ResultRange::ResultRange(ResultRange &&rhs)
+{
+    *this = std::move(rhs);
+}
+
+DNSResolver::ResultRange &DNSResolver::ResultRange::operator =(const ResultRange &rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    if (rhs.size_ > capacity_) {
+        if (data_ != inline_)
+            delete [] data_;
+        data_ = new ResultEntry[rhs.size_];
+        capacity_ = rhs.size_;
+    }
+    memcpy(data_, rhs.data_, rhs.size_ * sizeof(ResultEntry));
+    size_ = rhs.size_;
+    return *this;
+}
+
+DNSResolver::ResultRange &DNSResolver::ResultRange::operator =(ResultRange &&rhs)
+{
+    if (this == &rhs)
+        return *this;
+
+    if (rhs.data_ == rhs.inline_) {
+        *this = rhs;
+        rhs.size_ = 0;
+        return *this;
+    }
+
+    // 堆上的数组直接转移
+    if (data_ != inline_)
+        delete [] data_;
+    data_ = rhs.data_;
+    size_ = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.data_ = rhs.inline_;
+    rhs.size_ = 0;
+    rhs.capacity_ = INLINE_CAPACITY;
+    return *this;
+}
+
+DNSResolver::ResultRange::~ResultRange()
+{
+    if (data_ != inline_)
+        delete [] data_;
+}
+
+void DNSResolver::ResultRange::push_back(const sockaddr *sa, socklen_t salen)
+{
+    if (size_ == capacity_) {
+        ResultEntry *data = new ResultEntry[capacity_ * 2];
+        memcpy(data, data_, size_ * sizeof(ResultEntry));
+        if (data_ != inline_)
+            delete [] data_;
+        data_ = data;
+        capacity_ *= 2;
+    }
+
+    ResultEntry &entry = data_[size_++];
+    if (salen > (socklen_t) sizeof(entry.addr))
+        salen = sizeof(entry.addr);
+    memcpy(&entry.addr, sa, salen);
+    entry.addrLen = salen;
+}
+
+std::vector<SocketAddress> DNSResolver::ResultRange::toVector() const
+{
+    std::vector<SocketAddress> addrs;
+    addrs.reserve(size_);
+    for (uint32_t i = 0; i < size_; i++)
+        addrs.push_back(SocketAddress((sockaddr *) &data_[i].addr.sa, data_[i].addrLen));
+    return addrs;
+}
+
+// DNSResolver 
+DNSResolver::ResultRange DNSResolver::query(const char *host, const char *serv, addrinfo *hints)
+{
+    ResultRange result;
+    if (resolve_numeric(host, serv, hints->ai_family, result))
+        return result;
+
+    DNSCache &cache = DNSCache::instance();
+    bool cacheEnabled = cache.isEnabled();
+    DNSCache::Key key(host, serv, hints->ai_family, hints->ai_socktype);
+    int error;
+    if (cacheEnabled && lookup_cache(cache, key, result, error)) {
+        if (error != 0)
+            gai_error("Resolve DNS query failed (cached)", error);
+        return result;
+    }
+
+    InflightTable &inflight = InflightTable::instance();
+    InflightTable::Flight flight;
+    std::promise<ResultRange> promise;
+    if (!inflight.join(key, flight, promise))
+        return flight.get();    // 查询失败时重新抛出leader的GAIException
+
+    FlightLeader leader(inflight, key, promise);
+    try {
+        addrinfo *res;
+        int n = getaddrinfo(host, serv, hints, &res);
+        if (n != 0) {
+            if (cacheEnabled)
+                cache_result(cache, key, n, result);
+            gai_error("Resolve DNS query failed (getaddrinfo())", n);
+        }
+        leader.res = res;
 
-    return std::shared_ptr<addrinfo>(res, deleter);
+        result = ResultRange(res);
+        // 先写缓存再移除in-flight记录, 避免两者之间到达的线程重复查询
+        if (cacheEnabled)
+            cache_result(cache, key, 0, result);
+    } catch (...) {
+        leader.fail(std::current_exception());
+        throw;
+    }
+    leader.succeed(result);
+    return result;
 }
 
 DNSResolver::ResultRange DNSResolver::query(const char *host, const char *serv, 
@@ -33,7 +398,7 @@ DNSResolver::ResultRange DNSResolver::query(const char *host, const char *serv,
     hints.ai_family = AF_UNSPEC;
     hints.ai_socktype = (int) trans_type;
 
-    return ResultRange(query(host, serv, &hints));
+    return query(host, serv, &hints);
 }
 
 DNSResolver::ResultRange DNSResolver::query(const char *host, const char *serv, 
@@ -43,7 +408,119 @@ DNSResolver::ResultRange DNSResolver::query(const char *host, const char *serv,
     hints.ai_family = (int) net_type;
     hints.ai_socktype = (int) trans_type;
 
-    return ResultRange(query(host, serv, &hints));
+    return query(host, serv, &hints);
+}
+
+#if defined (__linux__)
+namespace {
+
+// 一个异步请求, 在getaddrinfo_a的完成通知中释放
+struct AsyncRequest {
+    gaicb cb = {};
+    addrinfo hints = {};
+    std::string host;
+    std::string serv;
+    bool cacheEnabled = false;
+    DNSCache::Key key;
+    DNSResolver::Callback callback;
+};
+
+}   // namespace
+
+void DNSResolver::queryAsync(const char *host, const char *serv, TransportLayerType trans_type,
+        Callback callback)
+{
+    ResultRange numeric;
+    if (resolve_numeric(host, serv, AF_UNSPEC, numeric)) {
+        callback(numeric, SocketError());
+        return;
+    }
+
+    std::unique_ptr<AsyncRequest> req(new AsyncRequest);
+    req->hints.ai_family = AF_UNSPEC;
+    req->hints.ai_socktype = (int) trans_type;
+    req->callback = callback;
+
+    DNSCache &cache = DNSCache::instance();
+    req->cacheEnabled = cache.isEnabled();
+    if (req->cacheEnabled) {
+        req->key = DNSCache::Key(host, serv, req->hints.ai_family, req->hints.ai_socktype);
+        ResultRange result;
+        int error;
+        if (lookup_cache(cache, req->key, result, error)) {
+            callback(result, error != 0 ? make_gai_error(error) : SocketError());
+            return;
+        }
+    }
+
+    if (host != NULL) {
+        req->host = host;
+        req->cb.ar_name = req->host.c_str();
+    }
+    if (serv != NULL) {
+        req->serv = serv;
+        req->cb.ar_service = req->serv.c_str();
+    }
+    req->cb.ar_request = &req->hints;
+
+    sigevent sev = {};
+    sev.sigev_notify = SIGEV_THREAD;
+    sev.sigev_value.sival_ptr = req.get();
+    sev.sigev_notify_function = [](sigval sv) {
+        std::unique_ptr<AsyncRequest> req((AsyncRequest *) sv.sival_ptr);
+        int n = ::gai_error(&req->cb);
+        if (n != 0) {
+            if (req->cacheEnabled)
+                cache_result(DNSCache::instance(), req->key, n, ResultRange());
+            req->callback(ResultRange(), make_gai_error(n));
+            return;
+        }
+
+        ResultRange result(req->cb.ar_result);
+        freeaddrinfo(req->cb.ar_result);
+        if (req->cacheEnabled)
+            cache_result(DNSCache::instance(), req->key, 0, result);
+        req->callback(result, SocketError());
+    };
+
+    gaicb *list[1] = { &req->cb };
+    int n = getaddrinfo_a(GAI_NOWAIT, list, 1, &sev);
+    if (n != 0) {
+        gai_error("Submit async DNS query failed (getaddrinfo_a())", n);
+    }
+    req.release();  // 由完成通知释放
+}
+
+std::future<DNSResolver::ResultRange> DNSResolver::queryAsync(const char *host, const char *serv,
+        TransportLayerType trans_type)
+{
+    std::shared_ptr<std::promise<ResultRange>> promise(new std::promise<ResultRange>);
+    std::future<ResultRange> future = promise->get_future();
+    queryAsync(host, serv, trans_type, [promise](ResultRange result, SocketError ec) {
+                if (ec.type == SocketError::no_error) {
+                    promise->set_value(result);
+                } else {
+                    promise->set_exception(std::make_exception_ptr(
+                                GAIException("Resolve DNS query failed (getaddrinfo_a())", ec.code)));
+                }
+            });
+    return future;
+}
+#endif
+
+void DNSResolver::enableCache(int ttlMs, size_t maxEntries, int maxStaleMs, int negativeTtlMs)
+{
+    DNSCache &cache = DNSCache::instance();
+    cache.setTTL(ttlMs);
+    cache.setMaxEntries(maxEntries);
+    cache.setMaxStale(maxStaleMs);
+    cache.setNegativeTTL(negativeTtlMs);
+    cache.setEnabled(true);
+}
+
+void DNSResolver::disableCache()
+{
+    DNSCache::instance().setEnabled(false);
 }
 
 }   // namesapce mini_socket
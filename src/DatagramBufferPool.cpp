@@ -0,0 +1,156 @@
+#include "DatagramBufferPool.hpp"
+#include "SYSException.hpp"
+
+#include <cerrno>
+#include <new>
+
+namespace mini_socket {
+
+static int round_up(int n, int align)
+{
+    return (n + align - 1) / align * align;
+}
+
+static char *align_up(char *ptr, int align)
+{
+    return (char *) (((uintptr_t) ptr + align - 1) & ~((uintptr_t) align - 1));
+}
+
+static uint64_t make_head(uint64_t tag, uint32_t link)
+{
+    return (tag << 32) | link;
+}
+
+// DatagramBuffer
+DatagramBuffer::DatagramBuffer(char *data, int capacity, uint32_t index):
+    data_(data), capacity_(capacity), index_(index), next_(0)
+{
+}
+
+// DatagramBufferPool
+DatagramBufferPool::DatagramBufferPool(int bufferCount, int bufferSize):
+    bufferCount_(bufferCount), bufferSize_(round_up(bufferSize, CACHE_LINE_SIZE)),
+    headerSize_(round_up(sizeof(DatagramBuffer), CACHE_LINE_SIZE)), head_(0)
+{
+    if (bufferCount <= 0 || bufferSize <= 0) {
+        sys_error("Construct DatagramBufferPool error: invalid buffer count or size", EINVAL);
+    }
+
+    size_t total = (size_t) bufferCount_ * (headerSize_ + bufferSize_) + CACHE_LINE_SIZE;
+    memory_ = new char[total];
+    headers_ = align_up(memory_, CACHE_LINE_SIZE);
+    data_ = headers_ + (size_t) bufferCount_ * headerSize_;
+
+    for (int i = 0; i < bufferCount_; i++) {
+        new (headers_ + (size_t) i * headerSize_) DatagramBuffer(
+                data_ + (size_t) i * bufferSize_, bufferSize_, i);
+    }
+
+    // 初始时所有缓存串成一条链表
+    for (int i = 0; i < bufferCount_ - 1; i++)
+        buffer(i)->next_.store(i + 2, std::memory_order_relaxed);
+    head_.store(make_head(0, 1), std::memory_order_release);
+}
+
+DatagramBufferPool::~DatagramBufferPool()
+{
+    for (int i = 0; i < bufferCount_; i++)
+        buffer(i)->~DatagramBuffer();
+    delete [] memory_;
+}
+
+DatagramBuffer *DatagramBufferPool::buffer(uint32_t index) const
+{
+    return (DatagramBuffer *) (headers_ + (size_t) index * headerSize_);
+}
+
+DatagramBuffer *DatagramBufferPool::acquire()
+{
+    uint64_t head = head_.load(std::memory_order_acquire);
+    for ( ; ; ) {
+        uint32_t link = (uint32_t) head;
+        if (link == 0)
+            return NULL;
+
+        // next_可能已被其它线程改写, 此时版本号也已变化, CAS会失败并重试
+        DatagramBuffer *top = buffer(link - 1);
+        uint32_t next = top->next_.load(std::memory_order_relaxed);
+        if (head_.compare_exchange_weak(head, make_head((head >> 32) + 1, next),
+                    std::memory_order_acquire, std::memory_order_acquire)) {
+            top->length = 0;
+            return top;
+        }
+    }
+}
+
+void DatagramBufferPool::release(DatagramBuffer *buffer)
+{
+    pushChain(buffer, buffer);
+}
+
+void DatagramBufferPool::pushChain(DatagramBuffer *first, DatagramBuffer *last)
+{
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    for ( ; ; ) {
+        last->next_.store((uint32_t) head, std::memory_order_relaxed);
+        if (head_.compare_exchange_weak(head, make_head((head >> 32) + 1, first->index_ + 1),
+                    std::memory_order_release, std::memory_order_relaxed))
+            return;
+    }
+}
+
+// DatagramBufferPool::LocalCache
+DatagramBufferPool::LocalCache::LocalCache(DatagramBufferPool &pool, int capacity):
+    pool_(pool), capacity_(capacity)
+{
+    if (capacity_ < 2)
+        capacity_ = 2;
+    if (capacity_ > MAX_CAPACITY)
+        capacity_ = MAX_CAPACITY;
+}
+
+DatagramBufferPool::LocalCache::~LocalCache()
+{
+    flush(count_);
+}
+
+DatagramBuffer *DatagramBufferPool::LocalCache::acquire()
+{
+    if (count_ == 0) {
+        int refill = capacity_ / 2;
+        while (count_ < refill) {
+            DatagramBuffer *buffer = pool_.acquire();
+            if (buffer == NULL)
+                break;
+            buffers_[count_++] = buffer;
+        }
+        if (count_ == 0)
+            return NULL;
+    }
+
+    DatagramBuffer *buffer = buffers_[--count_];
+    buffer->length = 0;
+    return buffer;
+}
+
+void DatagramBufferPool::LocalCache::release(DatagramBuffer *buffer)
+{
+    if (count_ == capacity_)
+        flush(capacity_ / 2);
+    buffers_[count_++] = buffer;
+}
+
+void DatagramBufferPool::LocalCache::flush(int count)
+{
+    if (count <= 0)
+        return;
+
+    // 先在本地把要归还的缓存串成链表, 再用一次CAS挂到全局链表上
+    DatagramBuffer *first = buffers_[count_ - count];
+    for (int i = count_ - count; i < count_ - 1; i++)
+        buffers_[i]->next_.store(buffers_[i + 1]->index_ + 1, std::memory_order_relaxed);
+    pool_.pushChain(first, buffers_[count_ - 1]);
+    count_ -= count;
+}
+
+}   // namespace mini_socket
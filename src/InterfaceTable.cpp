@@ -0,0 +1,448 @@
+#include "InterfaceTable.hpp"
+#include "SYSException.hpp"
+
+#if defined (__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <linux/if_addr.h>
+
+namespace mini_socket {
+
+using std::lock_guard;
+using std::mutex;
+
+namespace {
+
+const int BATCH = 8;            // 一次recvBatch最多接收的报文数
+const int MAX_DUMP_RETRIES = 3; // dump期间接口变化(NLM_F_DUMP_INTR)时的重试次数
+
+// 进程内唯一的快照代号, 0表示没有快照
+std::atomic<uint64_t> next_generation{0};
+
+// 本线程缓存的快照, 代号不同时才重新读取共享的快照
+struct SnapshotCache {
+    uint64_t generation = 0;
+    std::shared_ptr<const InterfaceSnapshot> snapshot;
+};
+
+thread_local SnapshotCache snapshot_cache;
+
+size_t address_length(int family)
+{
+    return family == AF_INET ? 4 : family == AF_INET6 ? 16 : 0;
+}
+
+// 取出sockaddr中的地址, IPv4映射的IPv6地址转换成IPv4; 返回地址族, 不支持时返回AF_UNSPEC
+int get_address(const sockaddr *sa, const uint8_t **addr)
+{
+    if (sa->sa_family == AF_INET) {
+        *addr = (const uint8_t *) &((const sockaddr_in *) sa)->sin_addr;
+        return AF_INET;
+    } else if (sa->sa_family == AF_INET6) {
+        const in6_addr *a6 = &((const sockaddr_in6 *) sa)->sin6_addr;
+        if (IN6_IS_ADDR_V4MAPPED(a6)) {
+            *addr = a6->s6_addr + 12;
+            return AF_INET;
+        }
+        *addr = a6->s6_addr;
+        return AF_INET6;
+    }
+    return AF_UNSPEC;
+}
+
+bool same_address(const InterfaceAddress &a, int family, const uint8_t *addr)
+{
+    return a.family == family && memcmp(a.address.bytes, addr, address_length(family)) == 0;
+}
+
+}   // namespace
+
+// InterfaceAddress
+CompactSocketAddress InterfaceAddress::toCompactAddress() const
+{
+    uint32_t scopeId = (family == AF_INET6 && scope == RT_SCOPE_LINK) ? index : 0;
+    return CompactSocketAddress(family, address, 0, scopeId);
+}
+
+bool InterfaceAddress::contains(int family, const uint8_t *addr) const
+{
+    if (family != this->family)
+        return false;
+
+    int bytes = prefixLen / 8;
+    int bits = prefixLen % 8;
+    if (memcmp(address.bytes, addr, bytes) != 0)
+        return false;
+    if (bits == 0)
+        return true;
+    uint8_t mask = (uint8_t) (0xff << (8 - bits));
+    return (address.bytes[bytes] & mask) == (addr[bytes] & mask);
+}
+
+bool InterfaceAddress::isUsable() const
+{
+    return (flags & (IFA_F_TENTATIVE | IFA_F_DEPRECATED | IFA_F_DADFAILED)) == 0;
+}
+
+// InterfaceSnapshot
+const InterfaceInfo *InterfaceSnapshot::findByIndex(int index) const
+{
+    auto it = std::lower_bound(interfaces_.begin(), interfaces_.end(), index,
+            [](const InterfaceInfo &info, int index) { return info.index < index; });
+    return (it != interfaces_.end() && it->index == index) ? &*it : NULL;
+}
+
+const InterfaceInfo *InterfaceSnapshot::findByName(const char *name) const
+{
+    for (const InterfaceInfo &info: interfaces_) {
+        if (info.name == name)
+            return &info;
+    }
+    return NULL;
+}
+
+uint32_t InterfaceSnapshot::getMtu(int index) const
+{
+    const InterfaceInfo *info = findByIndex(index);
+    return info != NULL ? info->mtu : 0;
+}
+
+bool InterfaceSnapshot::isLocalAddress(const sockaddr *sa) const
+{
+    const uint8_t *addr;
+    int family = get_address(sa, &addr);
+    if (family == AF_UNSPEC)
+        return false;
+
+    for (const InterfaceInfo &info: interfaces_) {
+        for (const InterfaceAddress &a: info.addresses) {
+            if (same_address(a, family, addr))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool InterfaceSnapshot::isLocalAddress(const CompactSocketAddress &addr) const
+{
+    sockaddr_storage ss;
+    if (addr.toSockaddr(&ss) == 0)
+        return false;
+    return isLocalAddress((const sockaddr *) &ss);
+}
+
+const InterfaceAddress *InterfaceSnapshot::findOnLink(const sockaddr *sa) const
+{
+    const uint8_t *addr;
+    int family = get_address(sa, &addr);
+    if (family == AF_UNSPEC)
+        return NULL;
+
+    const InterfaceAddress *best = NULL;
+    for (const InterfaceInfo &info: interfaces_) {
+        if (!info.isUp())
+            continue;
+        for (const InterfaceAddress &a: info.addresses) {
+            if (a.contains(family, addr) && (best == NULL || a.prefixLen > best->prefixLen))
+                best = &a;
+        }
+    }
+    return best;
+}
+
+const InterfaceAddress *InterfaceSnapshot::findSourceAddress(int index, int family) const
+{
+    const InterfaceInfo *info = findByIndex(index);
+    if (info == NULL)
+        return NULL;
+
+    // RT_SCOPE_UNIVERSE(0) < RT_SCOPE_SITE < RT_SCOPE_LINK < RT_SCOPE_HOST, 数值越小作用域越大
+    const InterfaceAddress *best = NULL;
+    for (const InterfaceAddress &a: info->addresses) {
+        if (a.family == family && a.isUsable() && (best == NULL || a.scope < best->scope))
+            best = &a;
+    }
+    return best;
+}
+
+// 应用一条链路或地址消息, 返回快照是否变化
+bool InterfaceSnapshot::apply(const NetlinkMessage &msg)
+{
+    LinkMessage link;
+    AddressMessage addr;
+    if (link.parse(msg)) {
+        apply(link);
+        return true;
+    } else if (addr.parse(msg)) {
+        apply(addr);
+        return true;
+    }
+    return false;
+}
+
+InterfaceInfo *InterfaceSnapshot::find(int index, bool create)
+{
+    auto it = std::lower_bound(interfaces_.begin(), interfaces_.end(), index,
+            [](const InterfaceInfo &info, int index) { return info.index < index; });
+    if (it != interfaces_.end() && it->index == index)
+        return &*it;
+    if (!create)
+        return NULL;
+
+    // 地址通知可能先于链路通知到达, 先插入一个只有序号的接口
+    InterfaceInfo info;
+    info.index = index;
+    return &*interfaces_.insert(it, std::move(info));
+}
+
+void InterfaceSnapshot::apply(const LinkMessage &link)
+{
+    if (!link.isNew) {
+        InterfaceInfo *info = find(link.index, false);
+        if (info != NULL)
+            interfaces_.erase(interfaces_.begin() + (info - interfaces_.data()));
+        return;
+    }
+
+    // 只更新消息中带有的属性
+    InterfaceInfo *info = find(link.index, true);
+    info->flags = link.flags;
+    info->linkType = link.linkType;
+    if (link.name != NULL)
+        info->name = link.name;
+    if (link.mtu != 0)
+        info->mtu = link.mtu;
+    if (link.operState != 0)
+        info->operState = link.operState;
+    if (link.hwAddress != NULL)
+        info->hwAddress.assign(link.hwAddress, link.hwAddress + link.hwAddressLen);
+}
+
+void InterfaceSnapshot::apply(const AddressMessage &addr)
+{
+    size_t len = address_length(addr.family);
+    if (len == 0 || addr.address == NULL)
+        return;
+
+    const uint8_t *bytes = (const uint8_t *) addr.address;
+    if (!addr.isNew) {
+        InterfaceInfo *info = find(addr.index, false);
+        if (info == NULL)
+            return;
+        auto &addresses = info->addresses;
+        addresses.erase(std::remove_if(addresses.begin(), addresses.end(),
+                    [&](const InterfaceAddress &a) {
+                        return a.prefixLen == addr.prefixLen && same_address(a, addr.family, bytes);
+                    }),
+                addresses.end());
+        return;
+    }
+
+    InterfaceInfo *info = find(addr.index, true);
+    InterfaceAddress *entry = NULL;
+    for (InterfaceAddress &a: info->addresses) {
+        if (a.prefixLen == addr.prefixLen && same_address(a, addr.family, bytes)) {
+            entry = &a;
+            break;
+        }
+    }
+    if (entry == NULL) {
+        info->addresses.push_back(InterfaceAddress());
+        entry = &info->addresses.back();
+        entry->family = addr.family;
+        memcpy(entry->address.bytes, bytes, len);
+        entry->prefixLen = addr.prefixLen;
+        entry->index = addr.index;
+    }
+    // 地址的状态(tentative, deprecated等)和作用域可能变化
+    entry->scope = addr.scope;
+    entry->flags = addr.flags;
+}
+
+// InterfaceTable
+InterfaceTable::InterfaceTable():
+    events_(NetlinkSocket::GROUP_LINK | NetlinkSocket::GROUP_IPV4_ADDRESS | NetlinkSocket::GROUP_IPV6_ADDRESS),
+    buffer_(NetlinkSocket::RECV_BUFFER_SIZE * BATCH)
+{
+    // 先加入多播组再dump, dump期间的变化留在队列中, 之后重复应用也不影响结果
+    lock_guard<mutex> lock(updateMutex_);
+    load();
+}
+
+InterfaceTable::~InterfaceTable()
+{
+    stop();
+}
+
+// 不析构: 其他线程在进程退出期间仍然可能读取
+InterfaceTable &InterfaceTable::instance()
+{
+    static InterfaceTable *table = []() {
+        InterfaceTable *t = new InterfaceTable;
+        t->start();
+        return t;
+    }();
+    return *table;
+}
+
+const InterfaceSnapshot &InterfaceTable::current() const
+{
+    SnapshotCache &cache = snapshot_cache;
+    if (cache.generation != generation_.load(std::memory_order_acquire)) {
+        cache.snapshot = std::atomic_load(&snapshot_);
+        cache.generation = cache.snapshot->generation();
+    }
+    return *cache.snapshot;
+}
+
+std::shared_ptr<const InterfaceSnapshot> InterfaceTable::snapshot() const
+{
+    return std::atomic_load(&snapshot_);
+}
+
+void InterfaceTable::start()
+{
+    if (thread_.joinable())
+        return;
+
+    stopFd_ = eventfd(0, EFD_CLOEXEC);
+    if (stopFd_ < 0) {
+        sys_error("eventfd error");
+    }
+    thread_ = std::thread(&InterfaceTable::run, this);
+}
+
+void InterfaceTable::stop()
+{
+    if (!thread_.joinable())
+        return;
+
+    // eventfd的计数不会溢出, 写入不会失败
+    uint64_t one = 1;
+    ssize_t n = ::write(stopFd_, &one, sizeof(one));
+    (void) n;
+    thread_.join();
+    ::close(stopFd_);
+    stopFd_ = -1;
+}
+
+bool InterfaceTable::processEvents()
+{
+    lock_guard<mutex> lock(updateMutex_);
+
+    std::shared_ptr<InterfaceSnapshot> next;
+    bool changed = false;
+    pollfd pfd = { events_.getNativeHandle(), POLLIN, 0 };
+    int lens[BATCH];
+    try {
+        while (::poll(&pfd, 1, 0) > 0) {
+            int n = events_.recvBatch(buffer_.data(), NetlinkSocket::RECV_BUFFER_SIZE, BATCH, lens);
+            if (!next)
+                next = std::make_shared<InterfaceSnapshot>(*snapshot_);
+            for (int i = 0; i < n; i++) {
+                const char *buf = buffer_.data() + i * NetlinkSocket::RECV_BUFFER_SIZE;
+                for (NetlinkMessage msg: NetlinkMessages(buf, lens[i]))
+                    changed |= next->apply(msg);
+            }
+        }
+    } catch (const SYSException &e) {
+        if (e.getSocketError().code != ENOBUFS)
+            throw;
+        // 内核丢弃了通知, 增量更新已经不可靠, 重新dump
+        load();
+        return true;
+    }
+
+    if (changed)
+        publish(next);
+    return changed;
+}
+
+void InterfaceTable::refresh()
+{
+    lock_guard<mutex> lock(updateMutex_);
+    load();
+}
+
+// 发送一个dump请求并把结果应用到快照上; 返回false表示dump被接口变化打断, 结果不完整
+bool InterfaceTable::dump(NetlinkSocket &sock, uint16_t type, std::vector<char> &buffer, InterfaceSnapshot &snapshot)
+{
+    uint32_t seq = sock.requestDump(type);
+    bool complete = true;
+    int lens[BATCH];
+    for ( ; ; ) {
+        int n = sock.recvBatch(buffer.data(), NetlinkSocket::RECV_BUFFER_SIZE, BATCH, lens);
+        for (int i = 0; i < n; i++) {
+            const char *buf = buffer.data() + i * NetlinkSocket::RECV_BUFFER_SIZE;
+            for (NetlinkMessage msg: NetlinkMessages(buf, lens[i])) {
+                if (msg.seq() != seq)
+                    continue;
+                if (msg.flags() & NLM_F_DUMP_INTR)
+                    complete = false;
+                if (msg.isDone())
+                    return complete;
+                if (msg.isError()) {
+                    sys_error("netlink dump error", msg.error());
+                }
+                snapshot.apply(msg);
+            }
+        }
+    }
+}
+
+// 调用者持有updateMutex_
+void InterfaceTable::load()
+{
+    NetlinkSocket sock(0);
+    std::shared_ptr<InterfaceSnapshot> next;
+    for (int retry = 0; ; retry++) {
+        next = std::make_shared<InterfaceSnapshot>();
+        bool complete = dump(sock, RTM_GETLINK, buffer_, *next);
+        complete = dump(sock, RTM_GETADDR, buffer_, *next) && complete;
+        if (complete || retry == MAX_DUMP_RETRIES)
+            break;
+    }
+    publish(next);
+}
+
+// 先替换快照再更新代号: 读者看到新代号时一定能取到不旧于它的快照
+void InterfaceTable::publish(std::shared_ptr<InterfaceSnapshot> next)
+{
+    next->generation_ = ++next_generation;
+    uint64_t generation = next->generation_;
+    std::atomic_store(&snapshot_, std::shared_ptr<const InterfaceSnapshot>(std::move(next)));
+    generation_.store(generation, std::memory_order_release);
+}
+
+void InterfaceTable::run()
+{
+    pollfd fds[2] = {
+        { events_.getNativeHandle(), POLLIN, 0 },
+        { stopFd_, POLLIN, 0 },
+    };
+    for ( ; ; ) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (fds[1].revents != 0)
+            return;
+        if (fds[0].revents != 0) {
+            try {
+                processEvents();
+            } catch (const SocketException &) {
+                // 保留原来的快照, 等待下一次通知
+            }
+        }
+    }
+}
+
+}   // namespace mini_socket
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file MonotonicClock.hpp
+ * @brief 库内部使用的CLOCK_MONOTONIC时间函数(不安装, 只在src中包含)
+ * @author hexu_1985@sina.com
+ * @version 1.0
+ * @date 2026-10-19
+ */
+#ifndef MINI_SOCKET_MONOTONIC_CLOCK_INC
+#define MINI_SOCKET_MONOTONIC_CLOCK_INC
+
+#if defined (__linux__)
+#include <cerrno>
+#include <cstdint>
+#include <ctime>
+
+namespace mini_socket {
+
+/**
+ * @brief 获取当前时间
+ *
+ * @return CLOCK_MONOTONIC的纳秒数
+ */
+inline int64_t monotonic_now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief 睡眠到指定的时刻
+ *
+ * @param deadline CLOCK_MONOTONIC的纳秒数
+ *
+ * @note 被信号中断时继续睡眠; 其他错误时直接返回, 调用者不能假定已经到达deadline
+ */
+inline void monotonic_sleep_until(int64_t deadline)
+{
+    timespec ts;
+    ts.tv_sec = deadline / 1000000000;
+    ts.tv_nsec = deadline % 1000000000;
+    // clock_nanosleep直接返回错误码, 不设置errno
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+}   // namespace mini_socket
+
+#endif
+
+#endif
@@ -0,0 +1,340 @@
+#include "NetlinkSocket.hpp"
+#include "SYSException.hpp"
+
+#if defined (__linux__)
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/if_addr.h>
+
+namespace mini_socket {
+
+// NetlinkAttributes
+NetlinkAttribute NetlinkAttributes::find(uint16_t type) const
+{
+    for (NetlinkAttribute attr: *this) {
+        if (attr.type() == type)
+            return attr;
+    }
+    return NetlinkAttribute();
+}
+
+void NetlinkAttributes::index(const rtattr **table, int maxType) const
+{
+    memset(table, 0, sizeof(const rtattr *) * (maxType + 1));
+    for (NetlinkAttribute attr: *this) {
+        if (attr.type() <= maxType)
+            table[attr.type()] = attr.get();
+    }
+}
+
+// LinkMessage
+bool LinkMessage::parse(const NetlinkMessage &msg)
+{
+    if (msg.type() != RTM_NEWLINK && msg.type() != RTM_DELLINK)
+        return false;
+    const ifinfomsg *ifi = msg.payloadAs<ifinfomsg>();
+    if (ifi == NULL)
+        return false;
+
+    *this = LinkMessage();
+    isNew = (msg.type() == RTM_NEWLINK);
+    index = ifi->ifi_index;
+    flags = ifi->ifi_flags;
+    change = ifi->ifi_change;
+    linkType = ifi->ifi_type;
+
+    // 一次遍历取出所有需要的属性
+    for (NetlinkAttribute attr: msg.attributes(sizeof(ifinfomsg))) {
+        switch (attr.type()) {
+        case IFLA_IFNAME:
+            name = attr.getString();
+            break;
+        case IFLA_MTU:
+            mtu = attr.getU32();
+            break;
+        case IFLA_OPERSTATE:
+            operState = attr.getU8();
+            break;
+        case IFLA_ADDRESS:
+            hwAddress = (const uint8_t *) attr.data();
+            hwAddressLen = attr.length();
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+// AddressMessage
+bool AddressMessage::parse(const NetlinkMessage &msg)
+{
+    if (msg.type() != RTM_NEWADDR && msg.type() != RTM_DELADDR)
+        return false;
+    const ifaddrmsg *ifa = msg.payloadAs<ifaddrmsg>();
+    if (ifa == NULL)
+        return false;
+
+    *this = AddressMessage();
+    isNew = (msg.type() == RTM_NEWADDR);
+    family = ifa->ifa_family;
+    index = ifa->ifa_index;
+    prefixLen = ifa->ifa_prefixlen;
+    scope = ifa->ifa_scope;
+    flags = ifa->ifa_flags;
+
+    // 点对点接口上IFA_ADDRESS是对端地址, IFA_LOCAL才是本端地址
+    const void *local = NULL;
+    size_t addrLen = (family == AF_INET) ? 4 : (family == AF_INET6) ? 16 : 0;
+    for (NetlinkAttribute attr: msg.attributes(sizeof(ifaddrmsg))) {
+        switch (attr.type()) {
+        case IFA_ADDRESS:
+            if (attr.length() == addrLen)
+                address = attr.data();
+            break;
+        case IFA_LOCAL:
+            if (attr.length() == addrLen)
+                local = attr.data();
+            break;
+        case IFA_LABEL:
+            label = attr.getString();
+            break;
+        case IFA_FLAGS:     // 8位的ifa_flags放不下的扩展标志
+            flags = attr.getU32();
+            break;
+        default:
+            break;
+        }
+    }
+    if (local != NULL)
+        address = local;
+    return true;
+}
+
+socklen_t AddressMessage::toSockaddr(sockaddr_storage *ss) const
+{
+    if (address == NULL)
+        return 0;
+
+    memset(ss, 0, sizeof(sockaddr_storage));
+    if (family == AF_INET) {
+        sockaddr_in *sin = (sockaddr_in *) ss;
+        sin->sin_family = AF_INET;
+        memcpy(&sin->sin_addr, address, sizeof(sin->sin_addr));
+        return sizeof(sockaddr_in);
+    } else if (family == AF_INET6) {
+        sockaddr_in6 *sin6 = (sockaddr_in6 *) ss;
+        sin6->sin6_family = AF_INET6;
+        memcpy(&sin6->sin6_addr, address, sizeof(sin6->sin6_addr));
+        if (scope == RT_SCOPE_LINK)
+            sin6->sin6_scope_id = index;
+        return sizeof(sockaddr_in6);
+    }
+    return 0;
+}
+
+// RouteMessage
+bool RouteMessage::parse(const NetlinkMessage &msg)
+{
+    if (msg.type() != RTM_NEWROUTE && msg.type() != RTM_DELROUTE)
+        return false;
+    const rtmsg *rtm = msg.payloadAs<rtmsg>();
+    if (rtm == NULL)
+        return false;
+
+    *this = RouteMessage();
+    isNew = (msg.type() == RTM_NEWROUTE);
+    family = rtm->rtm_family;
+    dstLen = rtm->rtm_dst_len;
+    table = rtm->rtm_table;
+    protocol = rtm->rtm_protocol;
+    scope = rtm->rtm_scope;
+    type = rtm->rtm_type;
+
+    for (NetlinkAttribute attr: msg.attributes(sizeof(rtmsg))) {
+        switch (attr.type()) {
+        case RTA_DST:
+            dst = attr.data();
+            break;
+        case RTA_GATEWAY:
+            gateway = attr.data();
+            break;
+        case RTA_PREFSRC:
+            prefSrc = attr.data();
+            break;
+        case RTA_OIF:
+            oif = (int) attr.getU32();
+            break;
+        case RTA_PRIORITY:
+            priority = attr.getU32();
+            break;
+        case RTA_TABLE:     // 表号大于255时rtm_table为RT_TABLE_COMPAT
+            table = attr.getU32();
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+// NetlinkSocket
+NetlinkSocket::NetlinkSocket(uint32_t groups, int protocol)
+{
+    open(protocol);
+    if (groups != 0)
+        subscribe(groups);
+}
+
+void NetlinkSocket::open(int protocol)
+{
+    createSocket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, protocol);
+
+    sockaddr_nl sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.nl_family = AF_NETLINK;      // nl_pid为0, 由内核分配
+    if (::bind(sockDesc_, (sockaddr *) &sa, sizeof(sa)) != 0) {
+        sys_error("bind error");
+    }
+}
+
+// RTMGRP_*是按位的旧式掩码, 第i位对应组号i + 1
+void NetlinkSocket::subscribe(uint32_t groups)
+{
+    for (int i = 0; i < 32; i++) {
+        if ((groups & (1u << i)) == 0)
+            continue;
+        int group = i + 1;
+        if (setsockopt(sockDesc_, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &group, sizeof(group)) != 0) {
+            sys_error("setsockopt(NETLINK_ADD_MEMBERSHIP) error");
+        }
+    }
+}
+
+void NetlinkSocket::unsubscribe(uint32_t groups)
+{
+    for (int i = 0; i < 32; i++) {
+        if ((groups & (1u << i)) == 0)
+            continue;
+        int group = i + 1;
+        if (setsockopt(sockDesc_, SOL_NETLINK, NETLINK_DROP_MEMBERSHIP, &group, sizeof(group)) != 0) {
+            sys_error("setsockopt(NETLINK_DROP_MEMBERSHIP) error");
+        }
+    }
+}
+
+uint32_t NetlinkSocket::getPortId() const
+{
+    sockaddr_nl sa;
+    socklen_t len = sizeof(sa);
+    if (getsockname(sockDesc_, (sockaddr *) &sa, &len) != 0) {
+        sys_error("getsockname error");
+    }
+    return sa.nl_pid;
+}
+
+uint32_t NetlinkSocket::sendRequest(uint16_t type, uint16_t flags, const void *payload, size_t payloadLen)
+{
+    nlmsghdr nh;
+    memset(&nh, 0, sizeof(nh));
+    nh.nlmsg_len = NLMSG_LENGTH(payloadLen);
+    nh.nlmsg_type = type;
+    nh.nlmsg_flags = flags | NLM_F_REQUEST;
+    nh.nlmsg_seq = ++seq_;
+
+    // 消息头和消息体分两段发送, 不需要拼接
+    static const char padding[NLMSG_ALIGNTO] = {};
+    iovec iov[3];
+    iov[0].iov_base = &nh;
+    iov[0].iov_len = sizeof(nh);
+    iov[1].iov_base = (void *) payload;
+    iov[1].iov_len = payloadLen;
+    iov[2].iov_base = (void *) padding;
+    iov[2].iov_len = NLMSG_ALIGN(payloadLen) - payloadLen;
+
+    sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &kernel;
+    msg.msg_namelen = sizeof(kernel);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 3;
+
+    if (::sendmsg(sockDesc_, &msg, 0) < 0) {
+        sys_error("Send failed (sendmsg())");
+    }
+
+    return nh.nlmsg_seq;
+}
+
+uint32_t NetlinkSocket::requestDump(uint16_t type, int family)
+{
+    // 与iproute2相同, 所有类型都用清零的ifinfomsg作为请求头, 第一个字节是地址族
+    ifinfomsg req;
+    memset(&req, 0, sizeof(req));
+    req.ifi_family = family;
+    return sendRequest(type, NLM_F_DUMP, &req, sizeof(req));
+}
+
+int NetlinkSocket::recv(char *buffer, int bufferLen)
+{
+    iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = bufferLen;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    int n = ::recvmsg(sockDesc_, &msg, 0);
+    if (n < 0) {
+        sys_error("Receive failed (recvmsg())");
+    }
+    if (msg.msg_flags & MSG_TRUNC) {
+        sys_error("Receive failed (recvmsg()): netlink message truncated", EMSGSIZE);
+    }
+
+    return n;
+}
+
+int NetlinkSocket::recvBatch(char *buffer, int datagramLen, int count, int *lens)
+{
+    if (count > MAX_BATCH)
+        count = MAX_BATCH;
+
+    iovec iovs[MAX_BATCH];
+    mmsghdr msgs[MAX_BATCH];
+    memset(msgs, 0, sizeof(mmsghdr) * count);
+    for (int i = 0; i < count; i++) {
+        iovs[i].iov_base = buffer + i * datagramLen;
+        iovs[i].iov_len = datagramLen;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // 阻塞直到第一个报文到达, 之后只取已经在队列中的报文
+    int n = ::recvmmsg(sockDesc_, msgs, count, MSG_WAITFORONE, NULL);
+    if (n < 0) {
+        sys_error("Receive failed (recvmmsg())");
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            sys_error("Receive failed (recvmmsg()): netlink message truncated", EMSGSIZE);
+        }
+        lens[i] = msgs[i].msg_len;
+    }
+
+    return n;
+}
+
+}   // namespace mini_socket
+
+#endif
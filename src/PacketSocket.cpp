@@ -0,0 +1,199 @@
+#include "PacketSocket.hpp"
+#include "SYSException.hpp"
+
+#if defined (__linux__)
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <net/if.h>
+#include <net/ethernet.h>
+#include <linux/if_packet.h>
+
+namespace mini_socket {
+
+// PacketBlock
+PacketFrame PacketBlock::iterator::operator *() const
+{
+    const tpacket3_hdr *hdr = (const tpacket3_hdr *) frame_;
+    PacketFrame frame;
+    frame.data = frame_ + hdr->tp_mac;
+    frame.captureLength = hdr->tp_snaplen;
+    frame.wireLength = hdr->tp_len;
+    frame.timestamp = (int64_t) hdr->tp_sec * 1000000000 + hdr->tp_nsec;
+    frame.rxhash = hdr->hv1.tp_rxhash;
+    return frame;
+}
+
+PacketBlock::iterator &PacketBlock::iterator::operator ++()
+{
+    const tpacket3_hdr *hdr = (const tpacket3_hdr *) frame_;
+    frame_ += hdr->tp_next_offset;
+    remaining_--;
+    return *this;
+}
+
+uint32_t PacketBlock::frameCount() const
+{
+    return ((const tpacket_block_desc *) desc_)->hdr.bh1.num_pkts;
+}
+
+PacketBlock::iterator PacketBlock::begin() const
+{
+    const tpacket_block_desc *desc = (const tpacket_block_desc *) desc_;
+    return iterator(desc_ + desc->hdr.bh1.offset_to_first_pkt, desc->hdr.bh1.num_pkts);
+}
+
+// PacketSocket
+PacketSocket::PacketSocket(const char *ifname, const PacketRingConfig &config)
+{
+    open(ifname, config);
+}
+
+PacketSocket::~PacketSocket()
+{
+    if (isOpened())
+        close();
+}
+
+void PacketSocket::open(const char *ifname, const PacketRingConfig &config)
+{
+    if (isOpened())
+        close();
+
+    // 先解析接口名, 避免映射了接收环之后才发现接口不存在
+    sockaddr_ll addr = {};
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    if (ifname != NULL) {
+        addr.sll_ifindex = if_nametoindex(ifname);
+        if (addr.sll_ifindex == 0) {
+            sys_error("Unknown interface (if_nametoindex())");
+        }
+    }
+
+    createSocket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+
+    // 构造函数中抛出异常时不会调用析构函数, 失败时在这里释放接收环和socket
+    try {
+        int version = TPACKET_V3;
+        if (setsockopt(sockDesc_, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) != 0) {
+            sys_error("Set TPACKET_V3 failed (setsockopt())");
+        }
+
+        tpacket_req3 req = {};
+        req.tp_block_size = config.blockSize;
+        req.tp_block_nr = config.blockCount;
+        req.tp_frame_size = config.frameSize;
+        req.tp_frame_nr = (unsigned) ((int64_t) config.blockSize * config.blockCount / config.frameSize);
+        req.tp_retire_blk_tov = config.blockTimeout;
+        req.tp_feature_req_word = TP_FT_REQ_FILL_RXHASH;
+        if (setsockopt(sockDesc_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) != 0) {
+            sys_error("Setup rx ring failed (setsockopt())");
+        }
+
+        size_t ringSize = (size_t) config.blockSize * config.blockCount;
+        void *ring = mmap(NULL, ringSize, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_LOCKED | MAP_POPULATE, sockDesc_, 0);
+        if (ring == MAP_FAILED) {
+            // 超出RLIMIT_MEMLOCK时不锁定内存再试一次
+            ring = mmap(NULL, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, sockDesc_, 0);
+            if (ring == MAP_FAILED) {
+                sys_error("Map rx ring failed (mmap())");
+            }
+        }
+        ring_ = (char *) ring;
+        ringSize_ = ringSize;
+        blockSize_ = config.blockSize;
+        blockCount_ = config.blockCount;
+        current_ = 0;
+
+        if (::bind(sockDesc_, (sockaddr *) &addr, sizeof(addr)) != 0) {
+            sys_error("bind error");
+        }
+    } catch (...) {
+        close();
+        throw;
+    }
+}
+
+void PacketSocket::close()
+{
+    if (ring_ != NULL) {
+        munmap(ring_, ringSize_);
+        ring_ = NULL;
+        ringSize_ = 0;
+    }
+    Socket::close();
+}
+
+void PacketSocket::joinFanout(uint16_t groupId, FanoutMode mode)
+{
+    int arg = groupId | (mode << 16);
+    if (setsockopt(sockDesc_, SOL_PACKET, PACKET_FANOUT, &arg, sizeof(arg)) != 0) {
+        sys_error("Join fanout group failed (setsockopt())");
+    }
+}
+
+bool PacketSocket::nextBlock(PacketBlock &block, int timeoutMs)
+{
+    tpacket_block_desc *desc = (tpacket_block_desc *) (ring_ + (size_t) current_ * blockSize_);
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    // block_status由内核写入, 需要acquire语义读取, 之后才能读块内容
+    while ((__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+        // poll可能因为其它事件或信号提前返回, 每次只等待剩余的时间
+        int left = -1;
+        if (timeoutMs >= 0) {
+            left = (int) std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            if (left < 0)
+                left = 0;
+        }
+
+        pollfd pfd;
+        pfd.fd = sockDesc_;
+        pfd.events = POLLIN | POLLERR;
+        pfd.revents = 0;
+        int n = poll(&pfd, 1, left);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            sys_error("Wait for rx ring failed (poll())");
+        }
+        if (n == 0)
+            return false;
+    }
+
+    block.desc_ = (char *) desc;
+    return true;
+}
+
+void PacketSocket::releaseBlock(PacketBlock &block)
+{
+    tpacket_block_desc *desc = (tpacket_block_desc *) block.desc_;
+    __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    block.desc_ = NULL;
+    current_ = (current_ + 1) % blockCount_;
+}
+
+PacketSocket::Statistics PacketSocket::getStatistics()
+{
+    tpacket_stats_v3 stats = {};
+    socklen_t len = sizeof(stats);
+    if (getsockopt(sockDesc_, SOL_PACKET, PACKET_STATISTICS, &stats, &len) != 0) {
+        sys_error("Get packet statistics failed (getsockopt())");
+    }
+
+    Statistics result;
+    result.packets = stats.tp_packets;
+    result.drops = stats.tp_drops;
+    result.freezeCount = stats.tp_freeze_q_cnt;
+    return result;
+}
+
+}   // namespace mini_socket
+
+#endif
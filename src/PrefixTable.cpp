@@ -0,0 +1,157 @@
+#include "PrefixTable.hpp"
+#include "SocketAddress.hpp"
+#include "SocketAddressView.hpp"
+
+#include <cstring>
+
+namespace mini_socket {
+
+PrefixTable::Node::Node()
+{
+    for (auto &slot: slots) {
+        slot.value = NO_MATCH;
+        slot.child = 0;
+        slot.len = 0;
+    }
+}
+
+void PrefixTable::Trie::insert(const uint8_t *addr, int prefixLen, int value)
+{
+    if (prefixLen == 0) {
+        defaultValue = value;
+        return;
+    }
+
+    // 找到(必要时创建)前缀最后一个字节所在的节点
+    int level = (prefixLen - 1) / 8;
+    uint32_t node = 0;
+    for (int i = 0; i < level; i++) {
+        uint32_t child = nodes[node].slots[addr[i]].child;
+        if (child == 0) {
+            child = nodes.size();
+            nodes.emplace_back();   // 可能使引用失效, 所以只保存下标
+            nodes[node].slots[addr[i]].child = child;
+        }
+        node = child;
+    }
+
+    // 前缀在本层剩下的位展开成连续的槽位, 不覆盖已有的更长前缀
+    int bits = prefixLen - level * 8;
+    int first = addr[level] & (0xff00 >> bits) & 0xff;
+    int count = 1 << (8 - bits);
+    for (int i = first; i < first + count; i++) {
+        Slot &slot = nodes[node].slots[i];
+        if ((int) slot.len <= prefixLen) {
+            slot.value = value;
+            slot.len = prefixLen;
+        }
+    }
+}
+
+int PrefixTable::Trie::lookup(const uint8_t *addr, int depth) const
+{
+    // 下层节点只包含更长的前缀, 所以沿路最后一个匹配就是最长匹配
+    int best = defaultValue;
+    const Node *node = &nodes[0];
+    for (int i = 0; i < depth; i++) {
+        const Slot &slot = node->slots[addr[i]];
+        if (slot.value >= 0)
+            best = slot.value;
+        if (slot.child == 0)
+            break;
+        node = &nodes[slot.child];
+    }
+    return best;
+}
+
+PrefixTable::PrefixTable()
+{
+}
+
+bool PrefixTable::insert(const char *cidr, int value)
+{
+    const char *slash = strchr(cidr, '/');
+    size_t addrLen = slash ? (size_t) (slash - cidr) : strlen(cidr);
+
+    sockaddr_storage ss;
+    socklen_t salen;
+    if (parse_address(cidr, addrLen, 0, &ss, &salen) != ParseAddressResult::OK)
+        return false;
+
+    int prefixLen = (ss.ss_family == AF_INET) ? 32 : 128;
+    if (slash != NULL) {
+        const char *p = slash + 1;
+        if (*p == '\0' || strlen(p) > 3)
+            return false;
+        int len = 0;
+        for ( ; *p != '\0'; p++) {
+            if (*p < '0' || *p > '9')
+                return false;
+            len = len * 10 + (*p - '0');
+        }
+        if (len > prefixLen)
+            return false;
+        prefixLen = len;
+    }
+
+    return insert((sockaddr *) &ss, prefixLen, value);
+}
+
+bool PrefixTable::insert(const sockaddr *sa, int prefixLen, int value)
+{
+    if (value < 0 || prefixLen < 0)
+        return false;
+
+    switch (sa->sa_family) {
+    case AF_INET:
+        if (prefixLen > 32)
+            return false;
+        v4_.insert((const uint8_t *) &((const sockaddr_in *) sa)->sin_addr, prefixLen, value);
+        return true;
+    case AF_INET6:
+        if (prefixLen > 128)
+            return false;
+        v6_.insert((const uint8_t *) &((const sockaddr_in6 *) sa)->sin6_addr, prefixLen, value);
+        return true;
+    default:
+        return false;
+    }
+}
+
+int PrefixTable::lookup(const sockaddr *sa) const
+{
+    if (sa == NULL)
+        return NO_MATCH;
+
+    switch (sa->sa_family) {
+    case AF_INET:
+        return v4_.lookup((const uint8_t *) &((const sockaddr_in *) sa)->sin_addr, 4);
+    case AF_INET6: {
+        const uint8_t *addr = (const uint8_t *) &((const sockaddr_in6 *) sa)->sin6_addr;
+        static const uint8_t v4mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+        if (memcmp(addr, v4mapped, sizeof(v4mapped)) == 0)
+            return v4_.lookup(addr + 12, 4);
+        return v6_.lookup(addr, 16);
+    }
+    default:
+        return NO_MATCH;
+    }
+}
+
+int PrefixTable::lookup(const SocketAddress &addr) const
+{
+    return lookup(addr.getSockaddr());
+}
+
+int PrefixTable::lookup(const SocketAddressView &addr) const
+{
+    return lookup(addr.getSockaddr());
+}
+
+void PrefixTable::clear()
+{
+    v4_ = Trie();
+    v6_ = Trie();
+}
+
+}   // namespace mini_socket
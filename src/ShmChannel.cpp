@@ -0,0 +1,367 @@
+#include "ShmChannel.hpp"
+#include "SYSException.hpp"
+
+#if defined (__linux__)
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mini_socket {
+
+using std::shared_ptr;
+using std::atomic;
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+using std::memory_order_seq_cst;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "ShmChannel needs lock-free atomic<uint32_t> in shared memory");
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bits");
+
+// 共享内存中一个方向的控制信息, 生产者和消费者写的字段在不同的缓存行
+struct ShmChannel::RingControl {
+    alignas(64) atomic<uint32_t> head;              // 生产者写入位置(字节数, 自由增长, 对环大小取模)
+    alignas(64) atomic<uint32_t> tail;              // 消费者读取位置
+    alignas(64) atomic<uint32_t> consumerWaiting;   // 消费者正在等待数据(futex字)
+    atomic<uint32_t> producerWaiting;               // 生产者正在等待空间(futex字)
+    atomic<uint32_t> closed;                        // 有一端已经关闭通道
+};
+
+namespace {
+
+const size_t HEADER_SIZE = 4096;    // 两个RingControl, 数据区从下一页开始
+const size_t MIN_RING_SIZE = 4096;
+const size_t MAX_RING_SIZE = (size_t) 1 << 30;
+const uint32_t HELLO_MAGIC = 0x4d534843;    // "MSHC"
+const uint32_t HELLO_VERSION = 1;
+const long LIVENESS_CHECK_NS = 100 * 1000 * 1000;   // 睡眠超过这个时间就检查一次对端进程是否还在
+
+// 握手报文, 同时传递memfd
+struct Hello {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ringSize;
+};
+
+size_t round_ring_size(size_t size)
+{
+    size_t n = MIN_RING_SIZE;
+    while (n < size && n < MAX_RING_SIZE)
+        n <<= 1;
+    return n;
+}
+
+inline void cpu_relax()
+{
+#if defined (__x86_64__) || defined (__i386__)
+    __builtin_ia32_pause();
+#elif defined (__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// 共享内存跨进程使用, 不能用FUTEX_PRIVATE_FLAG
+inline int futex_wait(atomic<uint32_t> &word, uint32_t value, const timespec *timeout)
+{
+    return (int) syscall(SYS_futex, &word, FUTEX_WAIT, value, timeout, NULL, 0);
+}
+
+inline void futex_wake(atomic<uint32_t> &word)
+{
+    syscall(SYS_futex, &word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+// 对端在等待时才唤醒; 调用前已经有seq_cst栅栏
+inline void wake_if_waiting(atomic<uint32_t> &waiting)
+{
+    if (waiting.load(memory_order_relaxed) && waiting.exchange(0, memory_order_relaxed))
+        futex_wake(waiting);
+}
+
+}   // namespace
+
+ShmChannel::ShmChannel(const SocketAddress &foreignAddress, size_t ringSize)
+{
+    UnixStreamSocket control(foreignAddress);
+    handshake(control, ringSize);
+    assign(control.release());
+}
+
+ShmChannel::~ShmChannel()
+{
+    unmap();
+}
+
+void ShmChannel::close()
+{
+    unmap();
+    Socket::close();
+}
+
+shared_ptr<ShmChannel> ShmChannel::accept(UnixServerSocket &server)
+{
+    auto control = server.accept();
+    shared_ptr<ShmChannel> channel(new ShmChannel);
+    channel->acceptHandshake(*control);
+    channel->assign(control->release());
+    return channel;
+}
+
+void ShmChannel::pair(ShmChannel &first, ShmChannel &second, size_t ringSize)
+{
+    UnixStreamSocket firstControl, secondControl;
+    UnixStreamSocket::pair(firstControl, secondControl);
+
+    // 握手报文在socket缓冲区里等待, 所以可以在同一个线程里先后完成两端的握手
+    first.handshake(firstControl, ringSize);
+    second.acceptHandshake(secondControl);
+    first.assign(firstControl.release());
+    second.assign(secondControl.release());
+}
+
+void ShmChannel::handshake(UnixStreamSocket &control, size_t ringSize)
+{
+    unmap();
+    ringSize = round_ring_size(ringSize);
+
+    int memfd = memfd_create("mini_socket.ShmChannel", MFD_CLOEXEC);
+    if (memfd < 0) {
+        sys_error("memfd_create error");
+    }
+
+    Hello hello;
+    hello.magic = HELLO_MAGIC;
+    hello.version = HELLO_VERSION;
+    hello.ringSize = ringSize;
+    try {
+        if (ftruncate(memfd, HEADER_SIZE + 2 * ringSize) != 0) {
+            sys_error("ftruncate error");
+        }
+        map(memfd, ringSize, true);
+
+        // memfd的内容初始为0, 这里只是显式地构造共享内存中的原子变量
+        new (txControl_) RingControl();
+        new (rxControl_) RingControl();
+
+        control.sendFds((const char *) &hello, sizeof(hello), &memfd, 1);
+    } catch (...) {
+        ::close(memfd);
+        unmap();
+        throw;
+    }
+    ::close(memfd);     // 映射保持有效
+}
+
+void ShmChannel::acceptHandshake(UnixStreamSocket &control)
+{
+    unmap();
+
+    Hello hello;
+    int memfd = -1;
+    int numFds = 1;
+    int n = control.recvFds((char *) &hello, sizeof(hello), &memfd, numFds);
+
+    struct stat st;
+    bool valid = (n == (int) sizeof(hello) && numFds == 1 &&
+            hello.magic == HELLO_MAGIC && hello.version == HELLO_VERSION &&
+            hello.ringSize == round_ring_size(hello.ringSize) &&
+            fstat(memfd, &st) == 0 && (uint64_t) st.st_size == HEADER_SIZE + 2 * hello.ringSize);
+    if (!valid) {
+        if (numFds == 1)
+            ::close(memfd);
+        sys_error("ShmChannel handshake failed", EPROTO);
+    }
+
+    try {
+        map(memfd, hello.ringSize, false);
+    } catch (...) {
+        ::close(memfd);
+        throw;
+    }
+    ::close(memfd);
+}
+
+void ShmChannel::map(int memfd, size_t ringSize, bool initiator)
+{
+    size_t memSize = HEADER_SIZE + 2 * ringSize;
+    void *mem = mmap(NULL, memSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, memfd, 0);
+    if (mem == MAP_FAILED) {
+        sys_error("mmap error");
+    }
+
+    mem_ = mem;
+    memSize_ = memSize;
+    ringSize_ = ringSize;
+
+    // 方向0: 发起方 -> 接受方, 方向1: 接受方 -> 发起方
+    RingControl *controls = (RingControl *) mem;
+    char *data = (char *) mem + HEADER_SIZE;
+    txControl_ = initiator ? &controls[0] : &controls[1];
+    rxControl_ = initiator ? &controls[1] : &controls[0];
+    txData_ = initiator ? data : data + ringSize;
+    rxData_ = initiator ? data + ringSize : data;
+
+    txHead_ = txTailCache_ = 0;
+    rxTail_ = rxHeadCache_ = 0;
+
+    // 单CPU时对端不可能在自旋期间运行, 自旋只会浪费时间片
+    spinCount_ = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 1000 : 0;
+}
+
+void ShmChannel::unmap()
+{
+    if (mem_ == nullptr)
+        return;
+
+    // 通知对端; release()之后的对象(如fork后不使用的一端)不代表这个连接, 不通知
+    if (isOpened()) {
+        txControl_->closed.store(1, memory_order_release);
+        rxControl_->closed.store(1, memory_order_release);
+        std::atomic_thread_fence(memory_order_seq_cst);
+        txControl_->consumerWaiting.store(0, memory_order_relaxed);
+        rxControl_->producerWaiting.store(0, memory_order_relaxed);
+        futex_wake(txControl_->consumerWaiting);
+        futex_wake(rxControl_->producerWaiting);
+    }
+
+    munmap(mem_, memSize_);
+    mem_ = nullptr;
+    memSize_ = 0;
+    ringSize_ = 0;
+    txControl_ = rxControl_ = nullptr;
+    txData_ = rxData_ = nullptr;
+}
+
+// 在position仍然等于value时睡眠; 返回false表示对端已关闭或退出
+bool ShmChannel::sleep(RingControl *control, atomic<uint32_t> &waiting,
+        const atomic<uint32_t> &position, uint32_t value)
+{
+    // 先声明正在等待再检查一次; 对端"更新位置, 检查等待标志"之间也有seq_cst栅栏,
+    // 两边至少有一方能看到对方的写入, 不会丢失唤醒
+    waiting.store(1, memory_order_relaxed);
+    std::atomic_thread_fence(memory_order_seq_cst);
+    if (position.load(memory_order_acquire) != value) {
+        waiting.store(0, memory_order_relaxed);
+        return true;
+    }
+    if (control->closed.load(memory_order_acquire)) {
+        waiting.store(0, memory_order_relaxed);
+        return false;
+    }
+
+    timespec timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = LIVENESS_CHECK_NS;
+    int ret = futex_wait(waiting, 1, &timeout);
+    int err = errno;
+    waiting.store(0, memory_order_relaxed);
+
+    if (control->closed.load(memory_order_acquire))
+        return false;
+
+    if (ret != 0 && err == ETIMEDOUT) {
+        // 对端进程异常退出时不会设置closed, 但Unix域socket会变为可读(EOF)
+        pollfd pfd;
+        pfd.fd = sockDesc_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (::poll(&pfd, 1, 0) > 0)
+            return false;
+    }
+
+    return true;
+}
+
+int ShmChannel::send(const char *buffer, int bufferLen)
+{
+    if (mem_ == nullptr || !isOpened()) {
+        sys_error("Send failed (ShmChannel)", ENOTCONN);
+    }
+    if (bufferLen <= 0)
+        return 0;
+
+    RingControl *control = txControl_;
+    uint32_t space = ringSize_ - (txHead_ - txTailCache_);
+    for (int spin = 0; space == 0; spin++) {
+        txTailCache_ = control->tail.load(memory_order_acquire);
+        space = ringSize_ - (txHead_ - txTailCache_);
+        if (space != 0)
+            break;
+
+        if (spin < spinCount_) {
+            cpu_relax();
+        } else if (!sleep(control, control->producerWaiting, control->tail, txTailCache_)) {
+            sys_error("Send failed (ShmChannel)", EPIPE);
+        }
+    }
+    if (control->closed.load(memory_order_relaxed)) {
+        sys_error("Send failed (ShmChannel)", EPIPE);
+    }
+
+    uint32_t n = (uint32_t) bufferLen < space ? (uint32_t) bufferLen : space;
+    size_t offset = txHead_ & (ringSize_ - 1);
+    size_t first = n < ringSize_ - offset ? n : ringSize_ - offset;
+    memcpy(txData_ + offset, buffer, first);
+    memcpy(txData_, buffer + first, n - first);
+
+    txHead_ += n;
+    control->head.store(txHead_, memory_order_release);
+    std::atomic_thread_fence(memory_order_seq_cst);
+    wake_if_waiting(control->consumerWaiting);
+
+    return n;
+}
+
+int ShmChannel::recv(char *buffer, int bufferLen)
+{
+    if (mem_ == nullptr || !isOpened()) {
+        sys_error("Receive failed (ShmChannel)", ENOTCONN);
+    }
+    if (bufferLen <= 0)
+        return 0;
+
+    RingControl *control = rxControl_;
+    uint32_t avail = rxHeadCache_ - rxTail_;
+    for (int spin = 0; avail == 0; spin++) {
+        rxHeadCache_ = control->head.load(memory_order_acquire);
+        avail = rxHeadCache_ - rxTail_;
+        if (avail != 0)
+            break;
+
+        if (spin < spinCount_) {
+            cpu_relax();
+        } else if (!sleep(control, control->consumerWaiting, control->head, rxTail_)) {
+            // 对端关闭之前写入的数据仍然要读完
+            rxHeadCache_ = control->head.load(memory_order_acquire);
+            avail = rxHeadCache_ - rxTail_;
+            if (avail == 0)
+                return 0;
+        }
+    }
+
+    uint32_t n = (uint32_t) bufferLen < avail ? (uint32_t) bufferLen : avail;
+    size_t offset = rxTail_ & (ringSize_ - 1);
+    size_t first = n < ringSize_ - offset ? n : ringSize_ - offset;
+    memcpy(buffer, rxData_ + offset, first);
+    memcpy(buffer + first, rxData_, n - first);
+
+    rxTail_ += n;
+    control->tail.store(rxTail_, memory_order_release);
+    std::atomic_thread_fence(memory_order_seq_cst);
+    wake_if_waiting(control->producerWaiting);
+
+    return n;
+}
+
+}   // namespace mini_socket
+
+#endif
@@ -60,9 +60,17 @@ _WSAStartupSharedHolder_::~_WSAStartupSharedHolder_()
 }   // namespace mini_socket
 
 #else
+#include <fcntl.h>
 #include <unistd.h>
 #endif
 
+#if defined (__linux__)
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
+#include <linux/net_tstamp.h>
+#endif
+
 namespace mini_socket {
 
 Socket::~Socket()
@@ -97,6 +105,20 @@ bool Socket::isOpened() const
     return sockDesc_ != INVALID_SOCKET; 
 }
 
+void Socket::assign(SOCKET sockDesc)
+{
+    if (isOpened())
+        close();
+    sockDesc_ = sockDesc;
+}
+
+SOCKET Socket::release()
+{
+    SOCKET sockDesc = sockDesc_;
+    sockDesc_ = INVALID_SOCKET;
+    return sockDesc;
+}
+
 SocketAddress Socket::getLocalAddress() const
 {
     sockaddr_storage addr;
@@ -140,4 +162,85 @@ void Socket::bind(const SocketAddress &localAddress)
     }
 }
 
+void Socket::setReceiveBufferSize(int size)
+{
+    if (setsockopt(sockDesc_, SOL_SOCKET, SO_RCVBUF, (const char *) &size, sizeof(size)) != 0) {
+        sys_error("Set receive buffer size failed (setsockopt())");
+    }
+}
+
+void Socket::setSendBufferSize(int size)
+{
+    if (setsockopt(sockDesc_, SOL_SOCKET, SO_SNDBUF, (const char *) &size, sizeof(size)) != 0) {
+        sys_error("Set send buffer size failed (setsockopt())");
+    }
+}
+
+void Socket::setNonBlocking(bool on)
+{
+#if defined (WIN32) || defined (_WIN32)
+    u_long mode = on ? 1 : 0;
+    if (ioctlsocket(sockDesc_, FIONBIO, &mode) != 0) {
+        sys_error("Set non-blocking failed (ioctlsocket())");
+    }
+#else
+    int flags = fcntl(sockDesc_, F_GETFL, 0);
+    if (flags < 0) {
+        sys_error("Set non-blocking failed (fcntl())");
+    }
+    flags = on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    if (fcntl(sockDesc_, F_SETFL, flags) < 0) {
+        sys_error("Set non-blocking failed (fcntl())");
+    }
+#endif
+}
+
+#if defined (__linux__)
+void Socket::setReusePort(bool on)
+{
+    int val = on ? 1 : 0;
+    if (setsockopt(sockDesc_, SOL_SOCKET, SO_REUSEPORT, &val, sizeof(val)) != 0) {
+        sys_error("Set reuse port failed (setsockopt())");
+    }
+}
+
+void Socket::enableTimestamping(bool hardware)
+{
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    if (hardware)
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+
+    if (setsockopt(sockDesc_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0)
+        return;
+
+    int on = 1;
+    if (setsockopt(sockDesc_, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0) {
+        sys_error("Enable timestamping failed (setsockopt())");
+    }
+}
+
+bool Socket::waitReadable(int timeoutMs)
+{
+    pollfd pfd = {};
+    pfd.fd = sockDesc_;
+    pfd.events = POLLIN;
+    // 被信号中断后只等待剩余的时间
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    int left = timeoutMs;
+    int n;
+    while ( (n = poll(&pfd, 1, left)) < 0 && errno == EINTR) {
+        if (timeoutMs < 0)
+            continue;
+        left = (int) std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (left < 0)
+            left = 0;
+    }
+    if (n < 0) {
+        sys_error("Wait readable failed (poll())");
+    }
+    return n > 0;
+}
+#endif
+
 }   // namespace mini_socket
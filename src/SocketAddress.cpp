@@ -2,11 +2,10 @@
 #include "SYSException.hpp"
 
 #include <cstring>
-#include <sstream>
+#include <ostream>
 
 namespace mini_socket {
 
-using std::ostringstream;
 using std::string;
 using std::tuple;
 
@@ -15,9 +14,8 @@ SocketAddress::SocketAddress(const char *address, uint16_t port): SocketAddress(
     if (setAddressPort(address, port))
         return;
 
-    ostringstream os;
-    os << "Construct SocketAddress error: the address is [" << address << "], and port is [" << port << "]";
-    sys_error(os.str());
+    sys_error(string("Construct SocketAddress error: the address is [") + address +
+            "], and port is [" + std::to_string(port) + "]");
 }
 
 SocketAddress::SocketAddress(sockaddr *addrVal, socklen_t addrLenVal):
@@ -28,23 +26,12 @@ SocketAddress::SocketAddress(sockaddr *addrVal, socklen_t addrLenVal):
 
 bool SocketAddress::setAddressPort(const char *address, uint16_t port)
 {
-    sockaddr *sa = (sockaddr *) &addr_;
-
-    sa->sa_family = AF_INET;
-    sockaddr_in	*sin = (sockaddr_in *) sa;
-    if (inet_pton(sa->sa_family, address, &sin->sin_addr) == 1) { // success
-        sin->sin_port = htons(port);
-        return true;
-    }
-
-    sa->sa_family = AF_INET6;
-    sockaddr_in6 *sin6 = (sockaddr_in6 *) sa;
-    if (inet_pton(sa->sa_family, address, &sin6->sin6_addr) == 1) { // success
-        sin6->sin6_port = htons(port);
-        return true;
-    }
-
-    return false;
+    return parse_address(address, strlen(address), port, &addr_, &addrLen_) == ParseAddressResult::OK;
+}
+
+bool SocketAddress::setAddressPort(const char *addressPort)
+{
+    return parse_address_port(addressPort, strlen(addressPort), &addr_, &addrLen_) == ParseAddressResult::OK;
 }
 
 string SocketAddress::toString() const
@@ -52,6 +39,11 @@ string SocketAddress::toString() const
     return to_string(getSockaddr(), getSockaddrLen());
 }
 
+size_t SocketAddress::format(char *buf, size_t len) const
+{
+    return format_address_port(getSockaddr(), getSockaddrLen(), buf, len);
+}
+
 tuple<string, uint16_t> SocketAddress::getAddressPort() const
 {
     return get_address_port(getSockaddr(), getSockaddrLen());
@@ -72,4 +64,11 @@ NetworkLayerType SocketAddress::getNetworkLayerType() const
     return get_network_layer_type(getSockaddr(), getSockaddrLen());
 }
 
+std::ostream &operator <<(std::ostream &os, const SocketAddress &addr)
+{
+    char str[ADDRESS_PORT_STRLEN];
+    size_t n = addr.format(str, sizeof(str));
+    return os.write(str, n);
+}
+
 }   // namesapce mini_socket
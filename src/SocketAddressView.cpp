@@ -1,5 +1,7 @@
 #include "SocketAddressView.hpp"
 
+#include <ostream>
+
 namespace mini_socket {
 
 using std::string;
@@ -14,6 +16,11 @@ string SocketAddressView::toString() const
     return to_string(getSockaddr(), getSockaddrLen());
 }
 
+size_t SocketAddressView::format(char *buf, size_t len) const
+{
+    return format_address_port(getSockaddr(), getSockaddrLen(), buf, len);
+}
+
 tuple<string, uint16_t> SocketAddressView::getAddressPort() const
 {
     return get_address_port(getSockaddr(), getSockaddrLen());
@@ -34,4 +41,11 @@ NetworkLayerType SocketAddressView::getNetworkLayerType() const
     return get_network_layer_type(getSockaddr(), getSockaddrLen());
 }
 
+std::ostream &operator <<(std::ostream &os, const SocketAddressView &addr)
+{
+    char str[ADDRESS_PORT_STRLEN];
+    size_t n = addr.format(str, sizeof(str));
+    return os.write(str, n);
+}
+
 }   // namesapce mini_socket
@@ -1,60 +1,481 @@
 #include "SocketCommon.hpp"
-#include <sstream>
+#include <cstring>
+
+#if !defined (WIN32) && !defined (_WIN32)
+#include <cstddef>
+#include <net/if.h>
+#include <sys/un.h>
+#endif
 
 namespace mini_socket {
 
-using std::ostringstream;
 using std::string;
 using std::tuple;
 
-tuple<string, uint16_t> get_address_port(const sockaddr *sa, socklen_t salen)
+namespace {
+
+const char hex_digits[] = "0123456789abcdef";
+
+// 写入无符号整数的十进制表示, 返回写入结束的位置
+char *format_uint(char *p, unsigned int v)
 {
-	static const tuple<string, uint16_t> null_result;
-	char str[128] = {0};
+    char tmp[10];
+    int n = 0;
+    do {
+        tmp[n++] = (char) ('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n > 0)
+        *p++ = tmp[--n];
+    return p;
+}
 
-	switch (sa->sa_family) {
-	case AF_INET: {
-		sockaddr_in	*sin = (sockaddr_in *) sa;
+char *format_ipv4(char *p, const unsigned char *a)
+{
+    for (int i = 0; i < 4; i++) {
+        if (i > 0)
+            *p++ = '.';
+        p = format_uint(p, a[i]);
+    }
+    return p;
+}
 
-		if (inet_ntop(AF_INET, &sin->sin_addr, str, sizeof(str)) == NULL)
-			return null_result;
+// 与inet_ntop的规则相同: 最长的一段(至少两组)连续0压缩成"::",
+// ::ffff:a.b.c.d和::a.b.c.d形式的地址末尾用点分十进制表示
+char *format_ipv6(char *p, const unsigned char *a)
+{
+    unsigned int words[8];
+    for (int i = 0; i < 8; i++)
+        words[i] = (a[2 * i] << 8) | a[2 * i + 1];
 
-        return make_tuple(string(str), ntohs(sin->sin_port));
-	}
+    int bestBase = -1, bestLen = 0;
+    for (int i = 0; i < 8; ) {
+        if (words[i] != 0) {
+            i++;
+            continue;
+        }
+        int j = i;
+        while (j < 8 && words[j] == 0)
+            j++;
+        if (j - i > bestLen) {
+            bestBase = i;
+            bestLen = j - i;
+        }
+        i = j;
+    }
+    if (bestLen < 2)
+        bestBase = -1;
 
-	case AF_INET6: {
-		sockaddr_in6	*sin6 = (sockaddr_in6 *) sa;
+    for (int i = 0; i < 8; i++) {
+        if (bestBase != -1 && i >= bestBase && i < bestBase + bestLen) {
+            if (i == bestBase)
+                *p++ = ':';
+            continue;
+        }
+        if (i != 0)
+            *p++ = ':';
+        if (i == 6 && bestBase == 0 && (bestLen == 6 || (bestLen == 5 && words[5] == 0xffff)))
+            return format_ipv4(p, a + 12);
 
-		if (inet_ntop(AF_INET6, &sin6->sin6_addr, str, sizeof(str)) == NULL)
-			return null_result;
+        unsigned int w = words[i];
+        bool started = false;
+        for (int shift = 12; shift >= 0; shift -= 4) {
+            unsigned int d = (w >> shift) & 0xf;
+            if (d != 0 || started || shift == 0) {
+                *p++ = hex_digits[d];
+                started = true;
+            }
+        }
+    }
+    if (bestBase != -1 && bestBase + bestLen == 8)
+        *p++ = ':';
+    return p;
+}
 
-        return make_tuple(string(str), ntohs(sin6->sin6_port));
-	}
+// 先写到栈上的临时缓冲区, 再按调用者缓冲区的长度复制
+size_t copy_out(const char *tmp, const char *end, char *buf, size_t len)
+{
+    size_t n = end - tmp;
+    if (n >= len)
+        return 0;
+    memcpy(buf, tmp, n);
+    buf[n] = '\0';
+    return n;
+}
 
-	default:
-        return null_result;
-	}
-    return null_result;
+// 十六进制数字的值, 不是十六进制数字的为-1
+const signed char hex_values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+inline int hex_value(char c)
+{
+    return hex_values[(unsigned char) c];
 }
 
-string to_string(const sockaddr *sa, socklen_t salen)
+inline bool is_digit(char c)
+{
+    return (unsigned char) (c - '0') < 10;
+}
+
+// 点分十进制, 每段1~3位且不能有前导0, 与inet_pton(AF_INET)相同
+bool parse_ipv4(const char *p, const char *end, unsigned char *out)
+{
+    for (int i = 0; i < 4; i++) {
+        if (i > 0) {
+            if (p == end || *p != '.')
+                return false;
+            p++;
+        }
+        if (p == end || !is_digit(*p))
+            return false;
+        unsigned int v = *p++ - '0';
+        if (p != end && is_digit(*p)) {
+            if (v == 0)
+                return false;
+            v = v * 10 + (*p++ - '0');
+            if (p != end && is_digit(*p)) {
+                v = v * 10 + (*p++ - '0');
+                if (v > 255)
+                    return false;
+            }
+        }
+        out[i] = (unsigned char) v;
+    }
+    return p == end;
+}
+
+// 与inet_pton(AF_INET6)相同: 每组1~4个十六进制数字, 至多一个"::"且至少代表一组,
+// 最后32位可以写成点分十进制
+bool parse_ipv6(const char *p, const char *end, unsigned char *out)
 {
-    static const string null_result;
+    uint16_t words[8];
+    int n = 0;
+    int colon = -1;     // "::"所在的组号
+
+    if (p == end)
+        return false;
+    if (*p == ':') {
+        if (end - p < 2 || p[1] != ':')
+            return false;
+        colon = 0;
+        p += 2;
+    }
+
+    while (p != end) {
+        const char *group = p;
+        int d = hex_value(*p);
+        if (d < 0)
+            return false;
+        unsigned int v = d;
+        p++;
+        // 最多再读三个数字, 第五个数字会在下面被当作非法分隔符拒绝
+        if (p != end && (d = hex_value(*p)) >= 0) {
+            v = (v << 4) | d;
+            p++;
+            if (p != end && (d = hex_value(*p)) >= 0) {
+                v = (v << 4) | d;
+                p++;
+                if (p != end && (d = hex_value(*p)) >= 0) {
+                    v = (v << 4) | d;
+                    p++;
+                }
+            }
+        }
+
+        if (p != end && *p == '.') {
+            unsigned char v4[4];
+            if (n > 6 || !parse_ipv4(group, end, v4))
+                return false;
+            words[n++] = (v4[0] << 8) | v4[1];
+            words[n++] = (v4[2] << 8) | v4[3];
+            break;
+        }
+
+        if (n == 8)
+            return false;
+        words[n++] = (uint16_t) v;
+
+        if (p == end)
+            break;
+        if (*p++ != ':' || p == end)
+            return false;
+        if (*p == ':') {
+            if (colon >= 0)
+                return false;
+            colon = n;
+            p++;
+        }
+    }
+
+    if (colon >= 0) {
+        if (n == 8)
+            return false;
+        int tail = n - colon;
+        memmove(words + 8 - tail, words + colon, tail * sizeof(uint16_t));
+        for (int i = colon; i < 8 - tail; i++)
+            words[i] = 0;
+    } else if (n != 8) {
+        return false;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        out[2 * i] = (unsigned char) (words[i] >> 8);
+        out[2 * i + 1] = (unsigned char) words[i];
+    }
+    return true;
+}
+
+bool parse_scope(const char *p, const char *end, uint32_t &scope)
+{
+    if (p == end)
+        return false;
+
+    if (is_digit(*p)) {
+        uint64_t v = 0;
+        for ( ; p != end; p++) {
+            if (!is_digit(*p))
+                return false;
+            v = v * 10 + (*p - '0');
+            if (v > UINT32_MAX)
+                return false;
+        }
+        scope = (uint32_t) v;
+        return true;
+    }
+
+#if !defined (WIN32) && !defined (_WIN32)
+    char name[IF_NAMESIZE];
+    if ((size_t) (end - p) >= sizeof(name))
+        return false;
+    memcpy(name, p, end - p);
+    name[end - p] = '\0';
+    scope = if_nametoindex(name);
+    return scope != 0;
+#else
+    return false;
+#endif
+}
+
+bool parse_port(const char *p, const char *end, uint16_t &port)
+{
+    if (p == end || end - p > 5)
+        return false;
+    unsigned int v = 0;
+    for ( ; p != end; p++) {
+        if (!is_digit(*p))
+            return false;
+        v = v * 10 + (*p - '0');
+    }
+    if (v > 65535)
+        return false;
+    port = (uint16_t) v;
+    return true;
+}
+
+#if !defined (WIN32) && !defined (_WIN32)
+// Unix域地址: 文件系统路径原样输出, 抽象地址(sun_path以'\0'开头)输出为"@name"
+size_t format_unix(const sockaddr *sa, socklen_t salen, char *buf, size_t len)
+{
+    const sockaddr_un *sun = (const sockaddr_un *) sa;
+    size_t offset = offsetof(sockaddr_un, sun_path);
+    if (salen <= (socklen_t) offset)
+        return 0;       // 未命名
+
+    size_t n = salen - offset;
+    if (n > sizeof(sun->sun_path))
+        n = sizeof(sun->sun_path);
+    if (sun->sun_path[0] != '\0') {
+        n = strnlen(sun->sun_path, n);
+    } else if (n == 1) {
+        return 0;
+    }
+    if (n >= len)
+        return 0;
+
+    memcpy(buf, sun->sun_path, n);
+    if (buf[0] == '\0')
+        buf[0] = '@';
+    buf[n] = '\0';
+    return n;
+}
+#endif
+
+}   // namespace
+
+ParseAddressResult parse_address(const char *str, size_t len, uint16_t port,
+        sockaddr_storage *ss, socklen_t *salen)
+{
+    const char *end = str + len;
+
+    sockaddr_in sin;
+    if (parse_ipv4(str, end, (unsigned char *) &sin.sin_addr)) {
+        memset(ss, 0, sizeof(sockaddr_in));
+        sockaddr_in *out = (sockaddr_in *) ss;
+        out->sin_family = AF_INET;
+        out->sin_addr = sin.sin_addr;
+        out->sin_port = htons(port);
+        *salen = sizeof(sockaddr_in);
+        return ParseAddressResult::OK;
+    }
+
+    // scope id在最后一个':'之后, 从末尾往回找'%'
+    const char *addrEnd = end;
+    for (const char *p = end; p != str && p[-1] != ':'; p--) {
+        if (p[-1] == '%') {
+            addrEnd = p - 1;
+            break;
+        }
+    }
+
+    sockaddr_in6 sin6;
+    if (!parse_ipv6(str, addrEnd, (unsigned char *) &sin6.sin6_addr))
+        return ParseAddressResult::INVALID_ADDRESS;
+
+    uint32_t scope = 0;
+    if (addrEnd != end && !parse_scope(addrEnd + 1, end, scope))
+        return ParseAddressResult::INVALID_SCOPE;
+
+    memset(ss, 0, sizeof(sockaddr_in6));
+    sockaddr_in6 *out = (sockaddr_in6 *) ss;
+    out->sin6_family = AF_INET6;
+    out->sin6_addr = sin6.sin6_addr;
+    out->sin6_port = htons(port);
+    out->sin6_scope_id = scope;
+    *salen = sizeof(sockaddr_in6);
+    return ParseAddressResult::OK;
+}
+
+ParseAddressResult parse_address_port(const char *str, size_t len,
+        sockaddr_storage *ss, socklen_t *salen)
+{
+    const char *end = str + len;
+    const char *host = str;
+    const char *hostEnd;
+    const char *colon;
+
+    if (len > 0 && *str == '[') {
+        host = str + 1;
+        hostEnd = (const char *) memchr(host, ']', end - host);
+        if (hostEnd == NULL || memchr(host, ':', hostEnd - host) == NULL)
+            return ParseAddressResult::INVALID_ADDRESS;
+        colon = hostEnd + 1;
+        if (colon == end || *colon != ':')
+            return ParseAddressResult::INVALID_PORT;
+    } else {
+        colon = end;
+        while (colon != str && colon[-1] != ':')
+            colon--;
+        if (colon == str)
+            return ParseAddressResult::INVALID_PORT;
+        hostEnd = --colon;
+        if (memchr(host, ':', hostEnd - host) != NULL)
+            return ParseAddressResult::INVALID_ADDRESS;     // 不带方括号的IPv6地址
+    }
 
-    string address;
     uint16_t port;
-    tie(address, port) = get_address_port(sa, salen);
-    if (address.empty())
+    if (!parse_port(colon + 1, end, port))
+        return ParseAddressResult::INVALID_PORT;
+    return parse_address(host, hostEnd - host, port, ss, salen);
+}
+
+size_t format_address(const sockaddr *sa, socklen_t salen, char *buf, size_t len)
+{
+    char tmp[ADDRESS_PORT_STRLEN];
+    char *p;
+
+    if (sa == NULL)
+        return 0;
+
+    switch (sa->sa_family) {
+    case AF_INET:
+        p = format_ipv4(tmp, (const unsigned char *) &((const sockaddr_in *) sa)->sin_addr);
+        break;
+    case AF_INET6:
+        p = format_ipv6(tmp, (const unsigned char *) &((const sockaddr_in6 *) sa)->sin6_addr);
+        break;
+#if !defined (WIN32) && !defined (_WIN32)
+    case AF_UNIX:
+        return format_unix(sa, salen, buf, len);
+#endif
+    default:
+        return 0;
+    }
+    return copy_out(tmp, p, buf, len);
+}
+
+size_t format_address_port(const sockaddr *sa, socklen_t salen, char *buf, size_t len)
+{
+    char tmp[ADDRESS_PORT_STRLEN];
+    char *p = tmp;
+
+    if (sa == NULL)
+        return 0;
+
+    switch (sa->sa_family) {
+    case AF_INET: {
+        const sockaddr_in *sin = (const sockaddr_in *) sa;
+        p = format_ipv4(p, (const unsigned char *) &sin->sin_addr);
+        *p++ = ':';
+        p = format_uint(p, ntohs(sin->sin_port));
+        break;
+    }
+    case AF_INET6: {
+        const sockaddr_in6 *sin6 = (const sockaddr_in6 *) sa;
+        *p++ = '[';
+        p = format_ipv6(p, (const unsigned char *) &sin6->sin6_addr);
+        *p++ = ']';
+        *p++ = ':';
+        p = format_uint(p, ntohs(sin6->sin6_port));
+        break;
+    }
+#if !defined (WIN32) && !defined (_WIN32)
+    case AF_UNIX:
+        return format_unix(sa, salen, buf, len);
+#endif
+    default:
+        return 0;
+    }
+    return copy_out(tmp, p, buf, len);
+}
+
+tuple<string, uint16_t> get_address_port(const sockaddr *sa, socklen_t salen)
+{
+    static const tuple<string, uint16_t> null_result;
+    char str[ADDRESS_PORT_STRLEN];
+
+    size_t n = format_address(sa, salen, str, sizeof(str));
+    if (n == 0)
         return null_result;
 
-    ostringstream os;
-    if (sa->sa_family == AF_INET6)
-        os << "[";
-    os << address;
-    if (sa->sa_family == AF_INET6)
-        os << "]";
-    os << ":" << port;
-    return os.str();
+    uint16_t port = 0;
+    if (sa->sa_family == AF_INET)
+        port = ntohs(((const sockaddr_in *) sa)->sin_port);
+    else if (sa->sa_family == AF_INET6)
+        port = ntohs(((const sockaddr_in6 *) sa)->sin6_port);
+    return make_tuple(string(str, n), port);
+}
+
+string to_string(const sockaddr *sa, socklen_t salen)
+{
+    char str[ADDRESS_PORT_STRLEN];
+    size_t n = format_address_port(sa, salen, str, sizeof(str));
+    return string(str, n);
 }
 
 mini_socket::NetworkLayerType get_network_layer_type(const sockaddr *sa, socklen_t salen)
@@ -67,6 +488,11 @@ mini_socket::NetworkLayerType get_network_layer_type(const sockaddr *sa, socklen
 	case AF_INET6:
         type = mini_socket::NetworkLayerType::IPv6;
         break;
+#if !defined (WIN32) && !defined (_WIN32)
+	case AF_UNIX:
+        type = mini_socket::NetworkLayerType::UNIX;
+        break;
+#endif
 	default:
         break;
 	}
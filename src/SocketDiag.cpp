@@ -0,0 +1,201 @@
+#include "SocketDiag.hpp"
+#include "SYSException.hpp"
+
+#if defined (__linux__)
+
+#include <algorithm>
+#include <sys/stat.h>
+
+namespace mini_socket {
+
+namespace {
+
+const int BATCH = 8;            // 一次recvBatch最多接收的报文数
+
+// 端口范围比较: 条件成立时跳到下一条指令, 不成立时跳出字节码(拒绝);
+// 比较的端口放在紧跟着的一条指令的no字段中
+void add_port_compare(std::vector<inet_diag_bc_op> &ops, uint8_t code, uint16_t port, int totalOps)
+{
+    int remaining = totalOps - (int) ops.size();
+    inet_diag_bc_op op;
+    op.code = code;
+    op.yes = 2 * sizeof(inet_diag_bc_op);
+    op.no = (uint16_t) ((remaining + 1) * sizeof(inet_diag_bc_op));
+    ops.push_back(op);
+
+    inet_diag_bc_op value;
+    value.code = INET_DIAG_BC_NOP;
+    value.yes = 0;
+    value.no = port;
+    ops.push_back(value);
+}
+
+// 生成"本端端口 == localPort && 对端端口 == remotePort"的过滤字节码;
+// 用GE/LE组合而不是S_EQ/D_EQ, 以兼容4.16之前的内核
+std::vector<inet_diag_bc_op> make_port_filter(uint16_t localPort, uint16_t remotePort)
+{
+    int totalOps = (localPort != 0 ? 4 : 0) + (remotePort != 0 ? 4 : 0);
+    std::vector<inet_diag_bc_op> ops;
+    if (localPort != 0) {
+        add_port_compare(ops, INET_DIAG_BC_S_GE, localPort, totalOps);
+        add_port_compare(ops, INET_DIAG_BC_S_LE, localPort, totalOps);
+    }
+    if (remotePort != 0) {
+        add_port_compare(ops, INET_DIAG_BC_D_GE, remotePort, totalOps);
+        add_port_compare(ops, INET_DIAG_BC_D_LE, remotePort, totalOps);
+    }
+    return ops;
+}
+
+CompactSocketAddress make_address(int family, const __be32 *addr, __be16 port, uint32_t ifindex)
+{
+    AddressBytes bytes = {};
+    memcpy(bytes.bytes, addr, family == AF_INET ? 4 : 16);
+    bool linkLocal = (family == AF_INET6 && IN6_IS_ADDR_LINKLOCAL((const in6_addr *) addr));
+    return CompactSocketAddress(family, bytes, ntohs(port), linkLocal ? ifindex : 0);
+}
+
+bool parse_entry(const NetlinkMessage &msg, SocketDiagEntry &entry)
+{
+    const inet_diag_msg *r = msg.payloadAs<inet_diag_msg>();
+    if (r == NULL || (r->idiag_family != AF_INET && r->idiag_family != AF_INET6))
+        return false;
+
+    entry.family = r->idiag_family;
+    entry.state = r->idiag_state;
+    entry.localAddress = make_address(r->idiag_family, r->id.idiag_src, r->id.idiag_sport, r->id.idiag_if);
+    entry.remoteAddress = make_address(r->idiag_family, r->id.idiag_dst, r->id.idiag_dport, r->id.idiag_if);
+    entry.inode = r->idiag_inode;
+    entry.uid = r->idiag_uid;
+    entry.cookie = ((uint64_t) r->id.idiag_cookie[1] << 32) | r->id.idiag_cookie[0];
+    entry.recvQueue = r->idiag_rqueue;
+    entry.sendQueue = r->idiag_wqueue;
+
+    for (NetlinkAttribute attr: msg.attributes(sizeof(inet_diag_msg))) {
+        switch (attr.type()) {
+        case INET_DIAG_INFO:    // 内核的tcp_info可能比头文件中的长或短
+            memcpy(&entry.tcpInfo, attr.data(), std::min(attr.length(), sizeof(tcp_info)));
+            entry.hasTcpInfo = true;
+            break;
+        case INET_DIAG_SKMEMINFO:
+            memcpy(entry.memInfo, attr.data(), std::min(attr.length(), sizeof(entry.memInfo)));
+            entry.hasMemInfo = true;
+            break;
+        case INET_DIAG_CONG:
+            if (attr.getString() != NULL)
+                strncpy(entry.congestion, attr.getString(), sizeof(entry.congestion) - 1);
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+}   // namespace
+
+// SocketDiagResult
+const SocketDiagEntry *SocketDiagResult::findByInode(uint32_t inode) const
+{
+    auto it = byInode_.find(inode);
+    return it != byInode_.end() ? &entries_[it->second] : NULL;
+}
+
+const SocketDiagEntry *SocketDiagResult::find(const Socket &sock) const
+{
+    return findByInode(SocketDiag::getInode(sock));
+}
+
+void SocketDiagResult::clear()
+{
+    entries_.clear();
+    byInode_.clear();
+}
+
+void SocketDiagResult::add(const SocketDiagEntry &entry)
+{
+    if (entry.inode != 0)
+        byInode_[entry.inode] = entries_.size();
+    entries_.push_back(entry);
+}
+
+// SocketDiag
+SocketDiag::SocketDiag():
+    sock_(0, NETLINK_SOCK_DIAG), buffer_(NetlinkSocket::RECV_BUFFER_SIZE * BATCH)
+{
+}
+
+void SocketDiag::query(const SocketDiagQuery &query, SocketDiagResult &result)
+{
+    this->query(query, [&result](const SocketDiagEntry &entry) { result.add(entry); });
+}
+
+int SocketDiag::query(const SocketDiagQuery &query, const std::function<void (const SocketDiagEntry &)> &callback)
+{
+    // 同一个netlink socket上同时只能有一个dump, 两个地址族依次查询
+    if (query.family == AF_UNSPEC)
+        return dump(AF_INET, query, callback) + dump(AF_INET6, query, callback);
+    return dump(query.family, query, callback);
+}
+
+uint32_t SocketDiag::getInode(const Socket &sock)
+{
+    struct stat st;
+    if (fstat(sock.getNativeHandle(), &st) != 0) {
+        sys_error("fstat error");
+    }
+    return (uint32_t) st.st_ino;
+}
+
+int SocketDiag::dump(int family, const SocketDiagQuery &query, const std::function<void (const SocketDiagEntry &)> &callback)
+{
+    // 请求: inet_diag_req_v2, 需要按端口过滤时后面跟一个INET_DIAG_REQ_BYTECODE属性
+    std::vector<inet_diag_bc_op> filter = make_port_filter(query.localPort, query.remotePort);
+    size_t filterLen = filter.size() * sizeof(inet_diag_bc_op);
+    char request[sizeof(inet_diag_req_v2) + RTA_SPACE(8 * sizeof(inet_diag_bc_op))];
+    memset(request, 0, sizeof(request));
+
+    inet_diag_req_v2 *req = (inet_diag_req_v2 *) request;
+    req->sdiag_family = family;
+    req->sdiag_protocol = query.protocol;
+    req->idiag_states = query.states;
+    req->idiag_ext = query.extensions;
+    size_t requestLen = sizeof(inet_diag_req_v2);
+    if (filterLen > 0) {
+        rtattr *rta = (rtattr *) (request + NLMSG_ALIGN(sizeof(inet_diag_req_v2)));
+        rta->rta_type = INET_DIAG_REQ_BYTECODE;
+        rta->rta_len = RTA_LENGTH(filterLen);
+        memcpy(RTA_DATA(rta), filter.data(), filterLen);
+        requestLen = NLMSG_ALIGN(sizeof(inet_diag_req_v2)) + RTA_SPACE(filterLen);
+    }
+    uint32_t seq = sock_.sendRequest(SOCK_DIAG_BY_FAMILY, NLM_F_DUMP, request, requestLen);
+
+    int count = 0;
+    int lens[BATCH];
+    for ( ; ; ) {
+        int n = sock_.recvBatch(buffer_.data(), NetlinkSocket::RECV_BUFFER_SIZE, BATCH, lens);
+        for (int i = 0; i < n; i++) {
+            const char *buf = buffer_.data() + i * NetlinkSocket::RECV_BUFFER_SIZE;
+            for (NetlinkMessage msg: NetlinkMessages(buf, lens[i])) {
+                if (msg.seq() != seq)
+                    continue;
+                if (msg.isDone())
+                    return count;
+                if (msg.isError()) {
+                    sys_error("sock_diag dump error", msg.error());
+                }
+
+                SocketDiagEntry entry;
+                entry.protocol = query.protocol;
+                if (parse_entry(msg, entry)) {
+                    callback(entry);
+                    count++;
+                }
+            }
+        }
+    }
+}
+
+}   // namespace mini_socket
+
+#endif
@@ -0,0 +1,59 @@
+#include "SocketTimestamp.hpp"
+
+#if defined (__linux__)
+#include <cstring>
+#include <ctime>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+namespace mini_socket {
+
+static int64_t to_nanoseconds(const timespec &ts)
+{
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+bool get_socket_timestamp(const msghdr *msg, SocketTimestamp &ts)
+{
+    bool found = false;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+            cmsg = CMSG_NXTHDR((msghdr *) msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec stamp;
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+            ts.software = to_nanoseconds(stamp);
+            found = true;
+        } else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // ts[0]: 软件时间戳, ts[1]: 已废弃, ts[2]: 原始硬件时间戳
+            scm_timestamping stamps;
+            memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            ts.software = to_nanoseconds(stamps.ts[0]);
+            ts.hardware = to_nanoseconds(stamps.ts[2]);
+            found = true;
+        } else if ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+            // 发送时间戳来自错误队列, 类型和序号记录在sock_extended_err中
+            sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_origin != SO_EE_ORIGIN_TIMESTAMPING)
+                continue;
+            ts.id = err.ee_data;
+            switch (err.ee_info) {
+            case SCM_TSTAMP_SCHED:
+                ts.type = SocketTimestamp::SCHEDULED;
+                break;
+            case SCM_TSTAMP_ACK:
+                ts.type = SocketTimestamp::ACKED;
+                break;
+            default:
+                ts.type = SocketTimestamp::SENT;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+}   // namespace mini_socket
+
+#endif
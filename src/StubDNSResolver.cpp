@@ -0,0 +1,521 @@
+#include "StubDNSResolver.hpp"
+#include "GAIException.hpp"
+#include "UDPSocket.hpp"
+#include "TCPSocket.hpp"
+
+#if defined (__linux__)
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <strings.h>
+
+namespace mini_socket {
+
+
+namespace {
+
+const int DNS_PORT = 53;
+const int DNS_HEADER_SIZE = 12;
+const int MAX_QUERY_SIZE = 300;         // 253字节的名字 + 头部 + 问题 + OPT
+const int MAX_UDP_RESPONSE = 1232;      // EDNS0通告的UDP应答大小
+const int MAX_TCP_RESPONSE = 65535;     // TCP应答的长度前缀是16位
+const int MAX_NAME_POINTERS = 64;       // 比较名字时最多跟随的压缩指针数, 防止指针成环
+const int MAX_ADDRESSES = 32;           // 每种记录最多保留的地址数
+
+const uint16_t TYPE_A = 1;
+const uint16_t TYPE_CNAME = 5;
+const uint16_t TYPE_AAAA = 28;
+const uint16_t TYPE_OPT = 41;
+const uint16_t CLASS_IN = 1;
+
+const int RCODE_NOERROR = 0;
+const int RCODE_SERVFAIL = 2;
+const int RCODE_NXDOMAIN = 3;
+
+inline uint16_t get16(const unsigned char *p)
+{
+    return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+inline void put16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char) (v >> 8);
+    p[1] = (unsigned char) v;
+}
+
+uint16_t next_query_id()
+{
+    thread_local std::mt19937 gen(std::random_device{}());
+    return (uint16_t) gen();
+}
+
+// 一个A或AAAA查询及其应答中的地址
+struct Question {
+    uint16_t type = 0;
+    uint16_t id = 0;
+    unsigned char packet[MAX_QUERY_SIZE];
+    int length = 0;
+    int questionEnd = 0;        // 问题段在packet中的结束位置
+    int rcode = -1;             // -1表示还没有收到应答
+    bool truncated = false;
+    int count = 0;
+    unsigned char addrs[MAX_ADDRESSES][16];
+};
+
+// 构造查询报文, 名字不合法返回false
+bool build_query(Question &q, const char *host, uint16_t type)
+{
+    unsigned char *p = q.packet;
+    memset(p, 0, DNS_HEADER_SIZE);
+    q.type = type;
+    q.id = next_query_id();
+    put16(p, q.id);
+    p[2] = 0x01;                // RD
+    put16(p + 4, 1);            // QDCOUNT
+    put16(p + 10, 1);           // ARCOUNT: OPT
+
+    int pos = DNS_HEADER_SIZE;
+    const char *label = host;
+    for ( ; ; ) {
+        const char *dot = strchr(label, '.');
+        size_t len = dot ? (size_t) (dot - label) : strlen(label);
+        if (len == 0) {
+            if (dot != NULL || label == host)   // 空标签, 或空名字
+                return false;
+            break;                              // 以'.'结尾的完整域名
+        }
+        if (len > 63 || pos + 1 + (int) len > DNS_HEADER_SIZE + 254)
+            return false;
+        p[pos++] = (unsigned char) len;
+        memcpy(p + pos, label, len);
+        pos += len;
+        if (dot == NULL)
+            break;
+        label = dot + 1;
+    }
+    p[pos++] = 0;
+    put16(p + pos, type);
+    put16(p + pos + 2, CLASS_IN);
+    pos += 4;
+    q.questionEnd = pos;
+
+    // EDNS0 OPT: 根名字, 类型41, class字段为UDP应答大小, TTL和RDLENGTH为0
+    p[pos++] = 0;
+    put16(p + pos, TYPE_OPT);
+    put16(p + pos + 2, MAX_UDP_RESPONSE);
+    memset(p + pos + 4, 0, 6);
+    pos += 10;
+
+    q.length = pos;
+    return true;
+}
+
+// 跳过一个(可能压缩的)名字, 返回名字之后的位置, 格式错误返回-1
+int skip_name(const unsigned char *msg, int len, int pos)
+{
+    while (pos < len) {
+        unsigned char c = msg[pos];
+        if (c == 0)
+            return pos + 1;
+        if ((c & 0xc0) == 0xc0)
+            return pos + 2 <= len ? pos + 2 : -1;
+        if ((c & 0xc0) != 0)
+            return -1;
+        pos += 1 + c;
+    }
+    return -1;
+}
+
+// 跟随压缩指针找到标签开始的位置, 格式错误返回-1
+int follow_pointers(const unsigned char *msg, int len, int pos, int &pointers)
+{
+    while (pos >= 0 && pos < len && (msg[pos] & 0xc0) == 0xc0) {
+        if (pos + 2 > len || ++pointers > MAX_NAME_POINTERS)
+            return -1;
+        pos = ((msg[pos] & 0x3f) << 8) | msg[pos + 1];
+    }
+    return pos < len ? pos : -1;
+}
+
+// 比较报文中两个(可能压缩的)名字, 不区分大小写
+bool same_name(const unsigned char *msg, int len, int a, int b)
+{
+    int pointers = 0;
+    for ( ; ; ) {
+        a = follow_pointers(msg, len, a, pointers);
+        b = follow_pointers(msg, len, b, pointers);
+        if (a < 0 || b < 0 || msg[a] != msg[b] || (msg[a] & 0xc0) != 0)
+            return false;
+        int n = msg[a];
+        if (n == 0)
+            return true;
+        if (a + 1 + n > len || b + 1 + n > len)
+            return false;
+        for (int i = 1; i <= n; i++) {
+            if (tolower(msg[a + i]) != tolower(msg[b + i]))
+                return false;
+        }
+        a += 1 + n;
+        b += 1 + n;
+    }
+}
+
+// 解析应答, 地址直接复制到Question中; 不是这个查询的应答返回false
+bool parse_response(const unsigned char *msg, int len, Question &q)
+{
+    if (len < DNS_HEADER_SIZE || get16(msg) != q.id || (msg[2] & 0x80) == 0)
+        return false;
+    if (get16(msg + 4) != 1)
+        return false;
+    // 问题段必须和查询逐字节相同
+    if (len < q.questionEnd ||
+            memcmp(msg + DNS_HEADER_SIZE, q.packet + DNS_HEADER_SIZE, q.questionEnd - DNS_HEADER_SIZE) != 0)
+        return false;
+
+    q.truncated = (msg[2] & 0x02) != 0;
+    q.rcode = msg[3] & 0x0f;
+    if (q.truncated || q.rcode != RCODE_NOERROR)
+        return true;
+
+    // 只接受属于查询名字或其CNAME链的记录, 链按答案段中的顺序跟随
+    int ancount = get16(msg + 6);
+    int pos = q.questionEnd;
+    int target = DNS_HEADER_SIZE;
+    for (int i = 0; i < ancount; i++) {
+        int owner = pos;
+        pos = skip_name(msg, len, pos);
+        if (pos < 0 || pos + 10 > len)
+            break;
+        uint16_t type = get16(msg + pos);
+        uint16_t klass = get16(msg + pos + 2);
+        int rdlen = get16(msg + pos + 8);
+        pos += 10;
+        if (pos + rdlen > len)
+            break;
+        if (klass == CLASS_IN && same_name(msg, len, owner, target)) {
+            if (type == TYPE_CNAME) {
+                target = pos;
+            } else if (type == q.type && q.count < MAX_ADDRESSES &&
+                    rdlen == (type == TYPE_A ? 4 : 16)) {
+                memcpy(q.addrs[q.count++], msg + pos, rdlen);
+            }
+        }
+        pos += rdlen;
+    }
+    return true;
+}
+
+bool is_done(const Question &q)
+{
+    return q.rcode >= 0 && !q.truncated;
+}
+
+// 只接受来自查询服务器的应答
+bool same_address(const sockaddr *a, const sockaddr *b)
+{
+    if (a->sa_family != b->sa_family)
+        return false;
+    if (a->sa_family == AF_INET) {
+        const sockaddr_in *x = (const sockaddr_in *) a, *y = (const sockaddr_in *) b;
+        return x->sin_port == y->sin_port && x->sin_addr.s_addr == y->sin_addr.s_addr;
+    }
+    const sockaddr_in6 *x = (const sockaddr_in6 *) a, *y = (const sockaddr_in6 *) b;
+    return x->sin6_port == y->sin6_port &&
+        memcmp(&x->sin6_addr, &y->sin6_addr, sizeof(x->sin6_addr)) == 0;
+}
+
+// 在UDP上向一个服务器发送所有查询并等待应答
+void exchange_udp(const SocketAddress &server, Question *questions, int count, int timeoutMs)
+{
+    UDPSocket sock;
+    for (int i = 0; i < count; i++) {
+        questions[i].rcode = -1;
+        questions[i].truncated = false;
+        questions[i].count = 0;
+        sock.sendTo((const char *) questions[i].packet, questions[i].length, server);
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    unsigned char buffer[MAX_UDP_RESPONSE];
+    SocketAddress source;
+    int pending = count;
+    while (pending > 0) {
+        int left = (int) std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (left <= 0 || !sock.waitReadable(left))
+            return;
+
+        int n = sock.recvFrom((char *) buffer, sizeof(buffer), source);
+        if (!same_address(source.getSockaddr(), server.getSockaddr()))
+            continue;
+        for (int i = 0; i < count; i++) {
+            if (questions[i].rcode < 0 && parse_response(buffer, n, questions[i])) {
+                pending--;
+                break;
+            }
+        }
+    }
+}
+
+bool recv_exactly(TCPSocket &sock, char *buffer, int len)
+{
+    while (len > 0) {
+        int n = sock.recv(buffer, len);
+        if (n <= 0)
+            return false;
+        buffer += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 应答被截断时在TCP上重新查询, buffer至少MAX_TCP_RESPONSE字节
+void exchange_tcp(const SocketAddress &server, Question &q, unsigned char *buffer)
+{
+    q.rcode = -1;
+    q.truncated = false;
+    q.count = 0;
+
+    TCPSocket sock(server);
+    unsigned char request[2 + MAX_QUERY_SIZE];
+    put16(request, (uint16_t) q.length);
+    memcpy(request + 2, q.packet, q.length);
+    sock.sendAll((const char *) request, 2 + q.length);
+
+    unsigned char header[2];
+    if (!recv_exactly(sock, (char *) header, 2))
+        return;
+    int len = get16(header);
+    if (!recv_exactly(sock, (char *) buffer, len))
+        return;
+    if (!parse_response(buffer, len, q))
+        q.rcode = -1;
+}
+
+uint16_t resolve_port(const char *serv, int socktype)
+{
+    if (serv == NULL || *serv == '\0')
+        return 0;
+
+    char *end;
+    unsigned long port = strtoul(serv, &end, 10);
+    if (*end == '\0') {
+        if (port > 65535)
+            gai_error("Resolve service failed", EAI_SERVICE);
+        return (uint16_t) port;
+    }
+
+    servent entry, *result = NULL;
+    char buffer[1024];
+    getservbyname_r(serv, socktype == SOCK_DGRAM ? "udp" : "tcp", &entry, buffer, sizeof(buffer), &result);
+    if (result == NULL)
+        gai_error("Resolve service failed", EAI_SERVICE);
+    return ntohs((uint16_t) result->s_port);
+}
+
+// 把地址复制到结果集中
+DNSResolver::ResultRange make_result(Question *questions, int count, uint16_t port)
+{
+    DNSResolver::ResultRange result;
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < questions[i].count; j++) {
+            if (questions[i].type == TYPE_A) {
+                sockaddr_in sin = {};
+                sin.sin_family = AF_INET;
+                sin.sin_port = htons(port);
+                memcpy(&sin.sin_addr, questions[i].addrs[j], 4);
+                result.push_back((sockaddr *) &sin, sizeof(sin));
+            } else {
+                sockaddr_in6 sin6 = {};
+                sin6.sin6_family = AF_INET6;
+                sin6.sin6_port = htons(port);
+                memcpy(&sin6.sin6_addr, questions[i].addrs[j], 16);
+                result.push_back((sockaddr *) &sin6, sizeof(sin6));
+            }
+        }
+    }
+    return result;
+}
+
+// 数字地址和localhost不需要查询
+bool fill_literal(const char *host, int family, Question *questions, int &count)
+{
+    unsigned char addr[16];
+    count = 0;
+    if (host == NULL || strcasecmp(host, "localhost") == 0 || strcasecmp(host, "localhost.") == 0) {
+        if (family != AF_INET6) {
+            Question &q = questions[count++];
+            q.type = TYPE_A;
+            q.count = 1;
+            memcpy(q.addrs[0], "\x7f\x00\x00\x01", 4);
+        }
+        if (family != AF_INET) {
+            Question &q = questions[count++];
+            q.type = TYPE_AAAA;
+            q.count = 1;
+            memset(q.addrs[0], 0, 16);
+            q.addrs[0][15] = 1;
+        }
+        return true;
+    }
+    if (inet_pton(AF_INET, host, addr) == 1) {
+        if (family == AF_INET6)
+            gai_error("Resolve DNS query failed", EAI_ADDRFAMILY);
+        questions[0].type = TYPE_A;
+        questions[0].count = 1;
+        memcpy(questions[0].addrs[0], addr, 4);
+        count = 1;
+        return true;
+    }
+    if (inet_pton(AF_INET6, host, addr) == 1) {
+        if (family == AF_INET)
+            gai_error("Resolve DNS query failed", EAI_ADDRFAMILY);
+        questions[0].type = TYPE_AAAA;
+        questions[0].count = 1;
+        memcpy(questions[0].addrs[0], addr, 16);
+        count = 1;
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const StubDNSResolver::Config> default_config()
+{
+    static std::shared_ptr<const StubDNSResolver::Config> config(
+            new StubDNSResolver::Config(StubDNSResolver::loadConfig()));
+    return config;
+}
+
+}   // namespace
+
+StubDNSResolver::StubDNSResolver(): config_(default_config())
+{
+}
+
+StubDNSResolver::StubDNSResolver(const Config &config)
+{
+    Config *c = new Config(config);
+    if (c->nameservers.empty())
+        c->nameservers.push_back(SocketAddress("127.0.0.1", DNS_PORT));
+    config_.reset(c);
+}
+
+StubDNSResolver::Config StubDNSResolver::loadConfig(const char *path)
+{
+    Config config;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream is(line);
+        std::string keyword;
+        if (!(is >> keyword) || keyword[0] == '#' || keyword[0] == ';')
+            continue;
+
+        std::string value;
+        if (keyword == "nameserver" && is >> value) {
+            // 去掉IPv6的%scope, 保持与glibc一样最多3个服务器
+            value = value.substr(0, value.find('%'));
+            SocketAddress addr;
+            if (config.nameservers.size() < 3 && addr.setAddressPort(value.c_str(), DNS_PORT))
+                config.nameservers.push_back(addr);
+        } else if (keyword == "options") {
+            while (is >> value) {
+                if (value.compare(0, 8, "timeout:") == 0)
+                    config.timeoutMs = atoi(value.c_str() + 8) * 1000;
+                else if (value.compare(0, 9, "attempts:") == 0)
+                    config.attempts = atoi(value.c_str() + 9);
+            }
+        }
+    }
+
+    if (config.timeoutMs <= 0)
+        config.timeoutMs = 5000;
+    if (config.attempts <= 0)
+        config.attempts = 1;
+    if (config.nameservers.empty())
+        config.nameservers.push_back(SocketAddress("127.0.0.1", DNS_PORT));
+    return config;
+}
+
+DNSResolver::ResultRange StubDNSResolver::query(const char *host, const char *serv,
+        TransportLayerType trans_type)
+{
+    return query(host, serv, AF_UNSPEC, (int) trans_type);
+}
+
+DNSResolver::ResultRange StubDNSResolver::query(const char *host, const char *serv,
+        NetworkLayerType net_type, TransportLayerType trans_type)
+{
+    return query(host, serv, (int) net_type, (int) trans_type);
+}
+
+DNSResolver::ResultRange StubDNSResolver::query(const char *host, const char *serv,
+        int family, int socktype)
+{
+    uint16_t port = resolve_port(serv, socktype);
+
+    Question questions[2];
+    int count = 0;
+    if (fill_literal(host, family, questions, count))
+        return DNSResolver::ResultRange(make_result(questions, count, port));
+
+    if (family != AF_INET6 && !build_query(questions[count++], host, TYPE_A))
+        gai_error("Resolve DNS query failed", EAI_NONAME);
+    if (family != AF_INET && !build_query(questions[count++], host, TYPE_AAAA))
+        gai_error("Resolve DNS query failed", EAI_NONAME);
+
+    const Config &config = *config_;
+    bool answered = false;
+    for (int attempt = 0; attempt < config.attempts && !answered; attempt++) {
+        for (const SocketAddress &server: config.nameservers) {
+            try {
+                exchange_udp(server, questions, count, config.timeoutMs);
+                for (int i = 0; i < count; i++) {
+                    if (!questions[i].truncated)
+                        continue;
+                    if (!tcpBuffer_)
+                        tcpBuffer_.reset(new unsigned char[MAX_TCP_RESPONSE]);
+                    exchange_tcp(server, questions[i], tcpBuffer_.get());
+                }
+            } catch (const SocketException &) {
+                // 服务器不可达(比如没有IPv6路由), 当作没有应答
+            }
+
+            // SERVFAIL或没有应答时换下一个服务器
+            answered = true;
+            for (int i = 0; i < count; i++) {
+                if (!is_done(questions[i]) || questions[i].rcode == RCODE_SERVFAIL)
+                    answered = false;
+            }
+            if (answered)
+                break;
+        }
+    }
+
+    int total = 0;
+    bool nxdomain = false;
+    bool failed = false;
+    for (int i = 0; i < count; i++) {
+        total += questions[i].count;
+        if (questions[i].rcode == RCODE_NXDOMAIN)
+            nxdomain = true;
+        else if (!is_done(questions[i]) || questions[i].rcode != RCODE_NOERROR)
+            failed = true;
+    }
+    if (total == 0) {
+        if (nxdomain || !failed)
+            gai_error("Resolve DNS query failed", EAI_NONAME);
+        gai_error("Resolve DNS query failed", answered ? EAI_FAIL : EAI_AGAIN);
+    }
+    return DNSResolver::ResultRange(make_result(questions, count, port));
+}
+
+}   // namespace mini_socket
+
+#endif
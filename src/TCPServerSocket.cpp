@@ -2,6 +2,10 @@
 #include "TCPSocket.hpp"
 #include "SYSException.hpp"
 
+#if !defined (WIN32) && !defined (_WIN32)
+#include <unistd.h>
+#endif
+
 namespace mini_socket {
 
 using std::shared_ptr;
@@ -24,12 +28,44 @@ void TCPServerSocket::listen(int backlog)
 
 shared_ptr<TCPSocket> TCPServerSocket::accept()
 {
-    SOCKET newConnSD;
-    if ((newConnSD = ::accept(sockDesc_, NULL, 0)) == INVALID_SOCKET) {
-        sys_error("Accept failed (accept())");
-    }
+    sockaddr_storage addr;
+    socklen_t addrLen;
+    SOCKET newConnSD = acceptFiltered(addr, addrLen);
+    return shared_ptr<TCPSocket>(new TCPSocket(newConnSD));
+}
 
+shared_ptr<TCPSocket> TCPServerSocket::accept(SocketAddress &peerAddress)
+{
+    sockaddr_storage addr;
+    socklen_t addrLen;
+    SOCKET newConnSD = acceptFiltered(addr, addrLen);
+    peerAddress = SocketAddress((sockaddr *) &addr, addrLen);
     return shared_ptr<TCPSocket>(new TCPSocket(newConnSD));
 }
 
+void TCPServerSocket::setAcceptFilter(PeerFilter filter)
+{
+    acceptFilter_ = std::move(filter);
+}
+
+SOCKET TCPServerSocket::acceptFiltered(sockaddr_storage &addr, socklen_t &addrLen)
+{
+    for ( ; ; ) {
+        SOCKET newConnSD;
+        addrLen = sizeof(addr);
+        if ((newConnSD = ::accept(sockDesc_, (sockaddr *) &addr, &addrLen)) == INVALID_SOCKET) {
+            sys_error("Accept failed (accept())");
+        }
+
+        if (!acceptFilter_ || acceptFilter_(SocketAddressView((sockaddr *) &addr, addrLen)))
+            return newConnSD;
+
+#if defined (WIN32) || defined (_WIN32)
+        closesocket(newConnSD);
+#else
+        ::close(newConnSD);
+#endif
+    }
+}
+
 }   // namesapce mini_socket
@@ -1,6 +1,14 @@
 #include "TCPSocket.hpp"
+#include "SYSException.hpp"
 #include <iostream>
 
+#if defined (__linux__)
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
+#include <linux/net_tstamp.h>
+#endif
+
 namespace mini_socket {
 
 using std::char_traits;
@@ -69,17 +77,69 @@ TCPSocket::TCPSocket(const SocketAddress &foreignAddress)
     connect(foreignAddress);
 }
 
-void TCPSocket::sendAll(const char *buffer, int bufferLen)
+#if defined (__linux__)
+void TCPSocket::enableTxTimestamping(bool hardware)
 {
-	auto ptr = (const char *) buffer;
-	auto nleft = bufferLen;
-    int nwritten = 0;
-	while (nleft > 0) {
-		nwritten = send(ptr, nleft);
-		nleft -= nwritten;
-		ptr   += nwritten;
-	}
+    int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+        SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+    if (hardware)
+        flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+
+    if (setsockopt(sockDesc_, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0) {
+        sys_error("Enable tx timestamping failed (setsockopt())");
+    }
+    txHardware_ = hardware;
+}
+
+int TCPSocket::sendSampled(const char *buffer, int bufferLen)
+{
+    iovec iov;
+    iov.iov_base = (void *) buffer;
+    iov.iov_len = bufferLen;
+
+    char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    // 只对本次sendmsg打开发送时间戳记录, 其余发送不受影响
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SO_TIMESTAMPING;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    int flags = SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE |
+        SOF_TIMESTAMPING_TX_ACK;
+    if (txHardware_)
+        flags |= SOF_TIMESTAMPING_TX_HARDWARE;
+    memcpy(CMSG_DATA(cmsg), &flags, sizeof(flags));
+
+    int n = ::sendmsg(sockDesc_, &msg, 0);
+    if ( n < 0 ) {
+        sys_error("Send failed (sendmsg())");
+    }
+
+    return n;
+}
+
+bool TCPSocket::recvTxTimestamp(SocketTimestamp &ts)
+{
+    char control[256];
+    msghdr msg = {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (::recvmsg(sockDesc_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return false;
+        sys_error("Receive tx timestamp failed (recvmsg())");
+    }
+
+    ts = SocketTimestamp();
+    return get_socket_timestamp(&msg, ts);
 }
+#endif
 
 iostream &TCPSocket::getStream()
 {
@@ -0,0 +1,55 @@
+#include "UDPPacer.hpp"
+#include "MonotonicClock.hpp"
+
+#if defined (__linux__)
+#include <algorithm>
+
+namespace mini_socket {
+
+UDPPacer::UDPPacer(UDPSocket &sock): sock_(sock)
+{
+}
+
+void UDPPacer::setPacketRate(double packetsPerSecond)
+{
+    nsPerPacket_ = packetsPerSecond > 0 ? 1e9 / packetsPerSecond : 0;
+}
+
+void UDPPacer::setBitRate(double bitsPerSecond)
+{
+    nsPerByte_ = bitsPerSecond > 0 ? 8e9 / bitsPerSecond : 0;
+}
+
+void UDPPacer::setMaxLead(int64_t nanoseconds)
+{
+    maxLead_ = nanoseconds;
+}
+
+int UDPPacer::sendTo(const char *buffer, int bufferLen,
+        const SocketAddress &foreignAddress)
+{
+    int64_t current = now();
+
+    // 落后于计划时不补发, 否则会形成突发
+    if (next_ < current)
+        next_ = current;
+
+    // 领先太多时在用户态等待, 让内核队列保持在maxLead_以内;
+    // 睡到只领先一半时再醒, 避免每个报文都睡眠一次
+    if (next_ - current > maxLead_)
+        monotonic_sleep_until((int64_t) next_ - maxLead_ / 2);
+
+    int64_t departure = (int64_t) next_;
+    next_ += std::max(nsPerPacket_, nsPerByte_ * bufferLen);
+
+    return sock_.sendTo(buffer, bufferLen, foreignAddress, departure);
+}
+
+int64_t UDPPacer::now()
+{
+    return monotonic_now();
+}
+
+}   // namespace mini_socket
+
+#endif
@@ -1,6 +1,17 @@
 #include "UDPSocket.hpp"
+#include "DatagramBufferPool.hpp"
+#include "MonotonicClock.hpp"
 #include "SYSException.hpp"
 
+#if defined (__linux__)
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sys/uio.h>
+#include <netinet/udp.h>
+#include <linux/net_tstamp.h>
+#endif
+
 namespace mini_socket {
 
 UDPSocket::UDPSocket(const SocketAddress &localAddress)
@@ -31,15 +42,233 @@ int UDPSocket::recvFrom(char *buffer, int bufferLen,
             SocketAddress &sourceAddress)
 {
     sockaddr_storage cliAddr;
-    socklen_t addrLen = sizeof(cliAddr);
-    int n = recvfrom(sockDesc_, buffer, bufferLen, 0,
-            (sockaddr *) &cliAddr, (socklen_t *) &addrLen);
-    if (n < 0) {
-        sys_error("Receive failed (recvfrom())");
-    }
+    socklen_t addrLen;
+    int n;
+    do {
+        addrLen = sizeof(cliAddr);
+        n = recvfrom(sockDesc_, buffer, bufferLen, 0,
+                (sockaddr *) &cliAddr, (socklen_t *) &addrLen);
+        if (n < 0) {
+            sys_error("Receive failed (recvfrom())");
+        }
+    } while (receiveFilter_ && !receiveFilter_(SocketAddressView((sockaddr *) &cliAddr, addrLen)));
     sourceAddress = SocketAddress((sockaddr *)&cliAddr, addrLen);
 
     return n;
 }
 
+int UDPSocket::recvFrom(DatagramBuffer &buffer)
+{
+    buffer.length = recvFrom(buffer.data(), buffer.capacity(), buffer.source);
+    return buffer.length;
+}
+
+void UDPSocket::setReceiveFilter(PeerFilter filter)
+{
+    receiveFilter_ = std::move(filter);
+}
+
+#if defined (__linux__)
+int UDPSocket::recvFrom(char *buffer, int bufferLen,
+            SocketAddress &sourceAddress, SocketTimestamp &ts)
+{
+    sockaddr_storage cliAddr;
+    iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = bufferLen;
+
+    char control[256];
+    msghdr msg = {};
+    int n;
+    do {
+        msg.msg_name = &cliAddr;
+        msg.msg_namelen = sizeof(cliAddr);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        n = recvmsg(sockDesc_, &msg, 0);
+        if (n < 0) {
+            sys_error("Receive failed (recvmsg())");
+        }
+    } while (receiveFilter_ && !receiveFilter_(SocketAddressView((sockaddr *) &cliAddr, msg.msg_namelen)));
+    sourceAddress = SocketAddress((sockaddr *)&cliAddr, msg.msg_namelen);
+
+    ts = SocketTimestamp();
+    get_socket_timestamp(&msg, ts);
+    return n;
+}
+#endif
+
+#if defined (__linux__)
+// 用户态等待到deadline: 先睡眠到临近时刻, 最后一小段忙等以保证精度
+static void wait_until(int64_t deadline)
+{
+    const int64_t SPIN_NS = 50000;
+    // 睡眠出错时由下面的忙等保证不早于deadline
+    if (deadline - monotonic_now() > SPIN_NS)
+        monotonic_sleep_until(deadline - SPIN_NS);
+    while (monotonic_now() < deadline)
+        ;
+}
+
+bool UDPSocket::enableTxTime()
+{
+    sock_txtime cfg = {};
+    cfg.clockid = CLOCK_MONOTONIC;
+    cfg.flags = 0;
+    txTimeEnabled_ = (setsockopt(sockDesc_, SOL_SOCKET, SO_TXTIME, &cfg, sizeof(cfg)) == 0);
+    return txTimeEnabled_;
+}
+
+int UDPSocket::sendTo(const char *buffer, int bufferLen,
+        const SocketAddress &foreignAddress, int64_t departureTime)
+{
+    if (!txTimeEnabled_) {
+        wait_until(departureTime);
+        return sendTo(buffer, bufferLen, foreignAddress);
+    }
+
+    iovec iov;
+    iov.iov_base = (void *) buffer;
+    iov.iov_len = bufferLen;
+
+    char control[CMSG_SPACE(sizeof(uint64_t))] = {};
+    msghdr msg = {};
+    msg.msg_name = foreignAddress.getSockaddr();
+    msg.msg_namelen = foreignAddress.getSockaddrLen();
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_TXTIME;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+    uint64_t txtime = departureTime;
+    memcpy(CMSG_DATA(cmsg), &txtime, sizeof(txtime));
+
+    int n = ::sendmsg(sockDesc_, &msg, 0);
+    if ( n < 0 ) {
+        sys_error("Send failed (sendmsg())");
+    }
+
+    return n;
+}
+
+int UDPSocket::sendBatch(const char *buffer, int datagramLen, int count,
+        const SocketAddress &foreignAddress)
+{
+    if (count > MAX_BATCH)
+        count = MAX_BATCH;
+
+    iovec iovs[MAX_BATCH];
+    mmsghdr msgs[MAX_BATCH];
+    memset(msgs, 0, sizeof(mmsghdr) * count);
+    for (int i = 0; i < count; i++) {
+        iovs[i].iov_base = (void *) (buffer + i * datagramLen);
+        iovs[i].iov_len = datagramLen;
+        msgs[i].msg_hdr.msg_name = foreignAddress.getSockaddr();
+        msgs[i].msg_hdr.msg_namelen = foreignAddress.getSockaddrLen();
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int n = ::sendmmsg(sockDesc_, msgs, count, 0);
+    if ( n < 0 ) {
+        sys_error("Send failed (sendmmsg())");
+    }
+
+    return n;
+}
+
+int UDPSocket::sendSegmented(const char *buffer, int bufferLen, int segmentSize,
+        const SocketAddress &foreignAddress)
+{
+    iovec iov;
+    iov.iov_base = (void *) buffer;
+    iov.iov_len = bufferLen;
+
+    char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+    msghdr msg = {};
+    msg.msg_name = foreignAddress.getSockaddr();
+    msg.msg_namelen = foreignAddress.getSockaddrLen();
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t gsoSize = segmentSize;
+    memcpy(CMSG_DATA(cmsg), &gsoSize, sizeof(gsoSize));
+
+    int n = ::sendmsg(sockDesc_, &msg, 0);
+    if ( n < 0 ) {
+        sys_error("Send failed (sendmsg())");
+    }
+
+    return n;
+}
+
+int UDPSocket::recvBatch(char *buffer, int datagramLen, int count, int *lens,
+        SocketTimestamp *ts)
+{
+    if (count > MAX_BATCH)
+        count = MAX_BATCH;
+
+    const int CONTROL_LEN = 64;
+    iovec iovs[MAX_BATCH];
+    mmsghdr msgs[MAX_BATCH];
+    char control[MAX_BATCH][CONTROL_LEN];
+    sockaddr_storage names[MAX_BATCH];  // 只在设置了源地址过滤器时使用
+    int n;
+    do {
+        memset(msgs, 0, sizeof(mmsghdr) * count);
+        for (int i = 0; i < count; i++) {
+            iovs[i].iov_base = buffer + i * datagramLen;
+            iovs[i].iov_len = datagramLen;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            if (ts != NULL) {
+                msgs[i].msg_hdr.msg_control = control[i];
+                msgs[i].msg_hdr.msg_controllen = CONTROL_LEN;
+            }
+            if (receiveFilter_) {
+                msgs[i].msg_hdr.msg_name = &names[i];
+                msgs[i].msg_hdr.msg_namelen = sizeof(names[i]);
+            }
+        }
+
+        // 阻塞直到第一个报文到达, 之后只取已经在队列中的报文
+        int received = ::recvmmsg(sockDesc_, msgs, count, MSG_WAITFORONE, NULL);
+        if (received < 0) {
+            sys_error("Receive failed (recvmmsg())");
+        }
+
+        // 丢弃被过滤器拒绝的报文, 后面的报文前移, 保持第i个报文在buffer + i * datagramLen
+        n = 0;
+        for (int i = 0; i < received; i++) {
+            if (receiveFilter_ && !receiveFilter_(SocketAddressView(
+                            (sockaddr *) &names[i], msgs[i].msg_hdr.msg_namelen)))
+                continue;
+            if (n != i)
+                memmove(buffer + n * datagramLen, buffer + i * datagramLen, msgs[i].msg_len);
+            lens[n] = msgs[i].msg_len;
+            if (ts != NULL) {
+                ts[n] = SocketTimestamp();
+                get_socket_timestamp(&msgs[i].msg_hdr, ts[n]);
+            }
+            n++;
+        }
+    } while (n == 0);
+
+    return n;
+}
+#endif
+
 }   // namesapce mini_socket
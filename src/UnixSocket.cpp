@@ -0,0 +1,326 @@
+#include "UnixSocket.hpp"
+#include "SYSException.hpp"
+
+#if !defined (WIN32) && !defined (_WIN32)
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mini_socket {
+
+using std::shared_ptr;
+using std::string;
+
+SocketAddress make_unix_address(const char *path)
+{
+    sockaddr_un sun = {};
+    size_t len = strlen(path);
+    if (len == 0 || len >= sizeof(sun.sun_path))
+        sys_error(string("Invalid unix socket path [") + path + "]", ENAMETOOLONG);
+
+    sun.sun_family = AF_UNIX;
+    memcpy(sun.sun_path, path, len);
+    return SocketAddress((sockaddr *) &sun, offsetof(sockaddr_un, sun_path) + len + 1);
+}
+
+#if defined (__linux__)
+SocketAddress make_abstract_unix_address(const char *name)
+{
+    sockaddr_un sun = {};
+    size_t len = strlen(name);
+    if (len + 1 > sizeof(sun.sun_path))
+        sys_error(string("Invalid abstract unix socket name [") + name + "]", ENAMETOOLONG);
+
+    sun.sun_family = AF_UNIX;
+    memcpy(sun.sun_path + 1, name, len);    // sun_path[0]为'\0'
+    return SocketAddress((sockaddr *) &sun, offsetof(sockaddr_un, sun_path) + 1 + len);
+}
+#endif
+
+namespace {
+
+// 删除残留的socket文件: 只删除socket类型的文件, 并且要确认没有进程在使用它
+void remove_stale_socket(const SocketAddress &addr, int type)
+{
+    const sockaddr_un *sun = (const sockaddr_un *) addr.getSockaddr();
+    if (sun->sun_family != AF_UNIX || sun->sun_path[0] == '\0')
+        return;     // 抽象地址随最后一个socket关闭自动消失
+
+    struct stat st;
+    if (stat(sun->sun_path, &st) != 0 || !S_ISSOCK(st.st_mode))
+        return;
+
+    int fd = socket(AF_UNIX, type, 0);
+    if (fd < 0)
+        return;
+    bool stale = (::connect(fd, addr.getSockaddr(), addr.getSockaddrLen()) != 0 && errno == ECONNREFUSED);
+    ::close(fd);
+    if (stale)
+        unlink(sun->sun_path);
+}
+
+int send_fds(SOCKET sockDesc, const char *buffer, int bufferLen, const SOCKET *fds, int numFds)
+{
+    // 字节流socket上没有数据时不会发送控制信息, 对端也无法区分空报文和连接关闭
+    if (bufferLen <= 0 || numFds < 0 || numFds > MAX_PASS_FDS) {
+        sys_error("Send failed (sendmsg()): invalid arguments", EINVAL);
+    }
+
+    union {
+        cmsghdr hdr;    // 保证对齐
+        char buf[CMSG_SPACE(sizeof(int) * MAX_PASS_FDS)];
+    } control;
+
+    iovec iov;
+    iov.iov_base = (void *) buffer;
+    iov.iov_len = bufferLen;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (numFds > 0) {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * numFds);
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * numFds);
+        memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * numFds);
+    }
+
+    int n = ::sendmsg(sockDesc, &msg, 0);
+    if (n < 0) {
+        sys_error("Send failed (sendmsg())");
+    }
+
+    return n;
+}
+
+int recv_fds(SOCKET sockDesc, char *buffer, int bufferLen, SOCKET *fds, int &numFds)
+{
+    int capacity = numFds < 0 ? 0 : (numFds > MAX_PASS_FDS ? MAX_PASS_FDS : numFds);
+    numFds = 0;
+
+    union {
+        cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(int) * MAX_PASS_FDS)];
+    } control;
+
+    iovec iov;
+    iov.iov_base = buffer;
+    iov.iov_len = bufferLen;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    // 按容量设置控制缓冲区的长度, 多出来的描述符由内核截断(MSG_CTRUNC)
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * (capacity > 0 ? capacity : 1));
+
+    int flags = 0;
+#if defined (MSG_CMSG_CLOEXEC)
+    flags |= MSG_CMSG_CLOEXEC;  // 接收到的描述符不会泄漏到exec的子进程
+#endif
+    int n = ::recvmsg(sockDesc, &msg, flags);
+    if (n < 0) {
+        sys_error("Receive failed (recvmsg())");
+    }
+
+    bool truncated = (msg.msg_flags & MSG_CTRUNC) != 0;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+
+        int count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const unsigned char *data = CMSG_DATA(cmsg);
+        for (int i = 0; i < count; i++) {
+            int fd;
+            memcpy(&fd, data + i * sizeof(int), sizeof(int));
+            if (numFds < capacity) {
+                fds[numFds++] = fd;
+            } else {
+                ::close(fd);
+                truncated = true;
+            }
+        }
+    }
+
+    if (truncated) {
+        for (int i = 0; i < numFds; i++)
+            ::close(fds[i]);
+        numFds = 0;
+        sys_error("Receive failed (recvmsg()): too many descriptors", EMSGSIZE);
+    }
+
+    return n;
+}
+
+}   // namespace
+
+// UnixStreamSocket
+UnixStreamSocket::UnixStreamSocket(SOCKET sockDesc)
+{
+    sockDesc_ = sockDesc;
+}
+
+UnixStreamSocket::UnixStreamSocket(const SocketAddress &foreignAddress, UnixSocketType type)
+{
+    createSocket(AF_UNIX, static_cast<int>(type), 0);
+    connect(foreignAddress);
+}
+
+void UnixStreamSocket::pair(UnixStreamSocket &first, UnixStreamSocket &second, UnixSocketType type)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, static_cast<int>(type), 0, fds) != 0) {
+        sys_error("socketpair error");
+    }
+
+    if (first.isOpened())
+        first.close();
+    if (second.isOpened())
+        second.close();
+    first.sockDesc_ = fds[0];
+    second.sockDesc_ = fds[1];
+}
+
+int UnixStreamSocket::sendFds(const char *buffer, int bufferLen, const SOCKET *fds, int numFds)
+{
+    return send_fds(sockDesc_, buffer, bufferLen, fds, numFds);
+}
+
+int UnixStreamSocket::recvFds(char *buffer, int bufferLen, SOCKET *fds, int &numFds)
+{
+    return recv_fds(sockDesc_, buffer, bufferLen, fds, numFds);
+}
+
+int UnixStreamSocket::sendSocket(Socket &sock, const char *buffer, int bufferLen)
+{
+    SOCKET sockDesc = sock.getNativeHandle();
+    int n = send_fds(sockDesc_, buffer, bufferLen, &sockDesc, 1);
+
+    // Socket::close会shutdown连接, 而对端进程还在使用它, 所以只关闭本进程的描述符
+    ::close(sock.release());
+    return n;
+}
+
+// UnixServerSocket
+UnixServerSocket::UnixServerSocket(const SocketAddress &localAddress, UnixSocketType type)
+{
+    createSocket(AF_UNIX, static_cast<int>(type), 0);
+    remove_stale_socket(localAddress, static_cast<int>(type));
+    bind(localAddress);
+    const int LISTENQ = 1024;
+    listen(LISTENQ);
+}
+
+void UnixServerSocket::listen(int backlog)
+{
+    if (::listen(sockDesc_, backlog) != 0) {
+        sys_error("listen error");
+    }
+}
+
+shared_ptr<UnixStreamSocket> UnixServerSocket::accept()
+{
+    SOCKET newConnSD;
+    if ((newConnSD = ::accept(sockDesc_, NULL, 0)) == INVALID_SOCKET) {
+        sys_error("Accept failed (accept())");
+    }
+
+    return shared_ptr<UnixStreamSocket>(new UnixStreamSocket(newConnSD));
+}
+
+// UnixDatagramSocket
+UnixDatagramSocket::UnixDatagramSocket(const SocketAddress &localAddress)
+{
+    createSocket(AF_UNIX, SOCK_DGRAM, 0);
+    remove_stale_socket(localAddress, SOCK_DGRAM);
+    bind(localAddress);
+}
+
+void UnixDatagramSocket::pair(UnixDatagramSocket &first, UnixDatagramSocket &second)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) != 0) {
+        sys_error("socketpair error");
+    }
+
+    if (first.isOpened())
+        first.close();
+    if (second.isOpened())
+        second.close();
+    first.sockDesc_ = fds[0];
+    second.sockDesc_ = fds[1];
+}
+
+int UnixDatagramSocket::sendTo(const char *buffer, int bufferLen, const SocketAddress &foreignAddress)
+{
+    if (!isOpened())
+        createSocket(AF_UNIX, SOCK_DGRAM, 0);
+
+    int n = ::sendto(sockDesc_, buffer, bufferLen, 0,
+            foreignAddress.getSockaddr(), foreignAddress.getSockaddrLen());
+    if (n < 0) {
+        sys_error("Send failed (sendto())");
+    }
+
+    return n;
+}
+
+int UnixDatagramSocket::recvFrom(char *buffer, int bufferLen, SocketAddress &sourceAddress)
+{
+    sockaddr_storage addr;
+    socklen_t addrLen = sizeof(addr);
+    int n = ::recvfrom(sockDesc_, buffer, bufferLen, 0, (sockaddr *) &addr, &addrLen);
+    if (n < 0) {
+        sys_error("Receive failed (recvfrom())");
+    }
+    sourceAddress = SocketAddress((sockaddr *) &addr, addrLen);
+
+    return n;
+}
+
+int UnixDatagramSocket::send(const char *buffer, int bufferLen)
+{
+    int n = ::send(sockDesc_, buffer, bufferLen, 0);
+    if (n < 0) {
+        sys_error("Send failed (send())");
+    }
+
+    return n;
+}
+
+int UnixDatagramSocket::recv(char *buffer, int bufferLen)
+{
+    int n = ::recv(sockDesc_, buffer, bufferLen, 0);
+    if (n < 0) {
+        sys_error("Receive failed (recv())");
+    }
+
+    return n;
+}
+
+int UnixDatagramSocket::sendFds(const char *buffer, int bufferLen, const SOCKET *fds, int numFds)
+{
+    return send_fds(sockDesc_, buffer, bufferLen, fds, numFds);
+}
+
+int UnixDatagramSocket::recvFds(char *buffer, int bufferLen, SOCKET *fds, int &numFds)
+{
+    return recv_fds(sockDesc_, buffer, bufferLen, fds, numFds);
+}
+
+}   // namespace mini_socket
+
+#endif
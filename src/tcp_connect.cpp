@@ -3,6 +3,13 @@
 #include "TCPSocket.hpp"
 #include "DNSResolver.hpp"
 
+#if defined (__linux__)
+#include <cerrno>
+#include <chrono>
+#include <vector>
+#include <poll.h>
+#endif
+
 namespace mini_socket {
 
 using std::shared_ptr;
@@ -25,4 +32,133 @@ shared_ptr<TCPSocket> tcp_connect(const char *host, const char *serv)
     sys_error("tcp connect error");
 }
 
+#if defined (__linux__)
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 按地址族交替排列, 以第一个结果的地址族开头(RFC 8305 4节)
+std::vector<SocketAddressView> interleave(const DNSResolver::ResultRange &results)
+{
+    std::vector<SocketAddressView> first, second;
+    for (const auto &addr: results) {
+        if (first.empty() || addr.getSockaddr()->sa_family == first[0].getSockaddr()->sa_family)
+            first.push_back(addr);
+        else
+            second.push_back(addr);
+    }
+
+    std::vector<SocketAddressView> addrs;
+    for (size_t i = 0; i < first.size() || i < second.size(); i++) {
+        if (i < first.size())
+            addrs.push_back(first[i]);
+        if (i < second.size())
+            addrs.push_back(second[i]);
+    }
+    return addrs;
+}
+
+int remaining_ms(Clock::time_point deadline)
+{
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return left > 0 ? (int) left : 0;
+}
+
+}   // namespace
+
+shared_ptr<TCPSocket> tcp_connect(const char *host, const char *serv, int attemptDelayMs, int timeoutMs)
+{
+    DNSResolver resolver;
+    DNSResolver::ResultRange results = resolver.query(host, serv, TransportLayerType::TCP);
+    std::vector<SocketAddressView> addrs = interleave(results);
+
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::vector<shared_ptr<TCPSocket>> attempts;    // 正在进行的连接
+    std::vector<pollfd> fds;
+    size_t next = 0;
+    Clock::time_point nextAttempt = Clock::now();
+    int lastError = ETIMEDOUT;
+
+    for ( ; ; ) {
+        // 到了下一次尝试的时间, 或者当前没有进行中的连接, 就发起下一个连接
+        while (next < addrs.size() && (attempts.empty() || Clock::now() >= nextAttempt)) {
+            const SocketAddressView &addr = addrs[next++];
+            shared_ptr<TCPSocket> sock(new TCPSocket);
+            SocketError ec;
+            if (!sock->open(addr.getNetworkLayerType(), TransportLayerType::TCP, ec)) {
+                lastError = ec.code;
+                continue;
+            }
+            sock->setNonBlocking(true);
+            if (sock->connect(addr, ec)) {
+                sock->setNonBlocking(false);
+                return sock;
+            }
+            if (ec.code != EINPROGRESS) {
+                lastError = ec.code;
+                continue;
+            }
+
+            pollfd pfd = {};
+            pfd.fd = sock->getNativeHandle();
+            pfd.events = POLLOUT;
+            fds.push_back(pfd);
+            attempts.push_back(sock);
+            nextAttempt = Clock::now() + std::chrono::milliseconds(attemptDelayMs);
+            break;
+        }
+
+        if (attempts.empty())
+            break;      // 所有地址都失败了
+
+        int wait = -1;
+        if (next < addrs.size())
+            wait = remaining_ms(nextAttempt);
+        if (timeoutMs >= 0) {
+            int left = remaining_ms(deadline);
+            if (left == 0) {
+                // 超时报告ETIMEDOUT, 而不是之前某个地址失败的错误
+                lastError = ETIMEDOUT;
+                break;
+            }
+            if (wait < 0 || left < wait)
+                wait = left;
+        }
+
+        int n = poll(fds.data(), fds.size(), wait);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            sys_error("tcp connect error (poll())");
+        }
+
+        for (size_t i = 0; i < fds.size(); ) {
+            if (fds[i].revents == 0) {
+                i++;
+                continue;
+            }
+
+            int error = 0;
+            socklen_t len = sizeof(error);
+            if (getsockopt(fds[i].fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0)
+                error = errno;
+            if (error == 0) {
+                // 第一个建立的连接胜出, 其余的连接随attempts析构关闭
+                shared_ptr<TCPSocket> sock = attempts[i];
+                sock->setNonBlocking(false);
+                return sock;
+            }
+
+            // 连接失败, 下一轮立即发起下一个连接
+            lastError = error;
+            fds.erase(fds.begin() + i);
+            attempts.erase(attempts.begin() + i);
+            nextAttempt = Clock::now();
+        }
+    }
+
+    sys_error("tcp connect error", lastError);
+}
+#endif
+
 }   // namespace mini_socket